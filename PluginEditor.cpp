@@ -4,7 +4,7 @@
 // WeightAlphaEditor implementation
 WeightAlphaEditor::WeightAlphaEditor(WeightAlphaProcessor& p)
     : AudioProcessorEditor(&p), audioProcessor(p),
-    freqListener([this](float, float) { updateFrequencyDisplay(); })
+    freqListener([this](float, float) { frequencyDisplayDirty.store(true, std::memory_order_relaxed); })
 {
     setOpaque(true); // Optimize rendering
     setBufferedToImage(true); // Improve rendering stability
@@ -44,10 +44,19 @@ WeightAlphaEditor::WeightAlphaEditor(WeightAlphaProcessor& p)
     freqRangeButton.setClickingTogglesState(true);
     freqRangeButton.setVisible(true);
 
-    // Preset Selector
+    // DSP load, and the adaptive quality tier while the governor is on
+    addAndMakeVisible(loadLabel);
+    loadLabel.setFont(juce::Font(juce::FontOptions{}.withHeight(13.0f).withName("Inter")));
+    loadLabel.setJustificationType(juce::Justification::centred);
+    loadLabel.setVisible(true);
+
+    // Preset Selector: programs are not parameters, so it drives the processor
+    // directly and the timer follows program changes made by the host
     addAndMakeVisible(presetSelector);
-    presetSelector.addItemList({ "Default", "Bass Boost", "Vocal Warmth" }, 1);
-    presetSelector.setSelectedId(1, juce::dontSendNotification);
+    for (int i = 0; i < audioProcessor.getNumPrograms(); ++i)
+        presetSelector.addItem(audioProcessor.getProgramName(i), i + 1);
+    presetSelector.setSelectedItemIndex(audioProcessor.getCurrentProgram(), juce::dontSendNotification);
+    presetSelector.onChange = [this] { audioProcessor.setCurrentProgram(presetSelector.getSelectedItemIndex()); };
     presetSelector.setVisible(true);
 
     // Parameter Attachments
@@ -57,7 +66,6 @@ WeightAlphaEditor::WeightAlphaEditor(WeightAlphaProcessor& p)
     strengthAttach = std::make_unique<SliderAttachment>(apvts, "strength", strengthKnob);
     bypassAttach = std::make_unique<ButtonAttachment>(apvts, "bypass", bypassButton);
     freqRangeAttach = std::make_unique<ButtonAttachment>(apvts, "freqRange", freqRangeButton);
-    presetAttach = std::make_unique<ComboBoxAttachment>(apvts, "currentProgram", presetSelector);
 
     // Attach listener to parameters
     apvts.getParameter("freq")->addListener(&freqListener);
@@ -68,6 +76,8 @@ WeightAlphaEditor::WeightAlphaEditor(WeightAlphaProcessor& p)
     setResizeLimits(450, 280, 800, 600);
     setSize(500, 300);
 
+    audioProcessor.getLoadHistogram().read(loadWindowStart);
+
     // Start the timer to update the UI
     startTimerHz(30);
 }
@@ -82,7 +92,13 @@ WeightAlphaEditor::~WeightAlphaEditor()
 
 void WeightAlphaEditor::timerCallback()
 {
-    updateFrequencyDisplay();
+    if (frequencyDisplayDirty.exchange(false, std::memory_order_relaxed))
+        updateFrequencyDisplay();
+
+    if (presetSelector.getSelectedItemIndex() != audioProcessor.getCurrentProgram())
+        presetSelector.setSelectedItemIndex(audioProcessor.getCurrentProgram(), juce::dontSendNotification);
+
+    updateLoadDisplay();
 }
 
 void WeightAlphaEditor::setupSlider(juce::Slider& slider, juce::Label& label, const juce::String& text)
@@ -103,6 +119,8 @@ void WeightAlphaEditor::setupSlider(juce::Slider& slider, juce::Label& label, co
 
 void WeightAlphaEditor::paint(juce::Graphics& g)
 {
+    WeightAlphaTrace::nameThisThread("message");
+    WeightAlphaTrace::Scope trace("paint", "editor");
     juce::ColourGradient gradient(juce::Colour(0xff222731), getLocalBounds().getTopLeft().toFloat(),
         juce::Colour(0xff1a1d24), getLocalBounds().getBottomLeft().toFloat(), false);
     g.setGradientFill(gradient);
@@ -153,6 +171,7 @@ void WeightAlphaEditor::resized()
     auto bottomArea = area;
     bypassButton.setBounds(bottomArea.removeFromLeft(40).withHeight(40));
     freqRangeButton.setBounds(bottomArea.removeFromRight(120).withHeight(40));
+    loadLabel.setBounds(bottomArea.withHeight(40).reduced(10, 0));
     juce::Logger::writeToLog("Bypass button bounds: " + bypassButton.getBounds().toString());
     juce::Logger::writeToLog("Freq range button bounds: " + freqRangeButton.getBounds().toString());
 }
@@ -171,4 +190,30 @@ void WeightAlphaEditor::updateFrequencyDisplay()
 
     if (freqValueLabel.getText() != freqText)
         freqValueLabel.setText(freqText, juce::dontSendNotification);
-}
\ No newline at end of file
+}
+
+void WeightAlphaEditor::updateLoadDisplay()
+{
+    const auto& histogram = audioProcessor.getLoadHistogram();
+
+    if (++ticksInLoadWindow >= 30)
+    {
+        histogram.read(loadWindowEnd);
+        loadStats = histogram.statsBetween(loadWindowStart, loadWindowEnd);
+        std::swap(loadWindowStart, loadWindowEnd);
+        ticksInLoadWindow = 0;
+    }
+
+    const auto percent = [](double load) { return juce::String(load * 100.0, 1) + "%"; };
+    juce::String text = "CPU " + percent(histogram.getCurrent()) + "  avg " + percent(loadStats.average)
+        + "  p99 " + percent(loadStats.p99);
+
+    if (audioProcessor.isAdaptiveQualityOn())
+    {
+        static const char* const tierNames[] = { "Full", "Reduced", "Economy" };
+        text << "\nQuality: " << tierNames[static_cast<int>(audioProcessor.getQualityTier())];
+    }
+
+    if (loadLabel.getText() != text)
+        loadLabel.setText(text, juce::dontSendNotification);
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include <JuceHeader.h>
+#include "WeightAlphaLoadMeter.h"
+#include "WeightAlphaRealtimeAudit.h"
 
 // Forward-declare the processor class to avoid circular includes
 class WeightAlphaProcessor;
@@ -93,6 +95,8 @@ public:
 };
 
 // Custom listener class for parameter changes
+// Hosts may change parameters from the audio thread, so the callback must not
+// block; the editor only flags the change and redraws from its timer
 class ParameterListener : public juce::AudioProcessorParameter::Listener
 {
 public:
@@ -100,6 +104,7 @@ public:
 
     void parameterValueChanged(int, float) override
     {
+        WeightAlphaRealtimeAudit::ScopedCallbackContext realtime("parameterValueChanged");
         if (onParameterChange)
             onParameterChange(0.0f, 0.0f);
     }
@@ -124,12 +129,13 @@ private:
     void timerCallback() override;
     void setupSlider(juce::Slider& slider, juce::Label& label, const juce::String& text);
     void updateFrequencyDisplay();
+    void updateLoadDisplay();
 
     WeightAlphaProcessor& audioProcessor;
     WeightAlphaLookAndFeel lookAndFeel;
 
     juce::Slider freqKnob, weightKnob, strengthKnob;
-    juce::Label freqLabel, weightLabel, strengthLabel, freqValueLabel, titleLabel, bypassLabel;
+    juce::Label freqLabel, weightLabel, strengthLabel, freqValueLabel, titleLabel, bypassLabel, loadLabel;
 
     juce::ToggleButton bypassButton, freqRangeButton;
     juce::ComboBox presetSelector;
@@ -137,13 +143,17 @@ private:
     using APVTS = juce::AudioProcessorValueTreeState;
     using SliderAttachment = APVTS::SliderAttachment;
     using ButtonAttachment = APVTS::ButtonAttachment;
-    using ComboBoxAttachment = APVTS::ComboBoxAttachment;
 
     std::unique_ptr<SliderAttachment> freqAttach, weightAttach, strengthAttach;
     std::unique_ptr<ButtonAttachment> bypassAttach, freqRangeAttach;
-    std::unique_ptr<ComboBoxAttachment> presetAttach;
 
     ParameterListener freqListener;
+    std::atomic<bool> frequencyDisplayDirty{ true };
+
+    // Load statistics cover one-second windows between two histogram snapshots
+    WeightAlphaDSP::LoadHistogram::Snapshot loadWindowStart, loadWindowEnd;
+    WeightAlphaDSP::LoadStats loadStats;
+    int ticksInLoadWindow = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WeightAlphaEditor)
 };
\ No newline at end of file
@@ -8,12 +8,44 @@ WeightAlphaProcessor::WeightAlphaProcessor()
         .withOutput("Output", juce::AudioChannelSet::stereo(), true))
     , apvts(*this, nullptr, "Parameters", createParameterLayout())
 {
-    apvts.state.setProperty("currentProgram", 0, nullptr);
     freqParamPtr = apvts.getRawParameterValue("freq");
     weightParamPtr = apvts.getRawParameterValue("weight");
     strengthParamPtr = apvts.getRawParameterValue("strength");
     bypassParamPtr = apvts.getRawParameterValue("bypass");
     freqRangeParamPtr = apvts.getRawParameterValue("freqRange");
+    ditherParamPtr = apvts.getRawParameterValue("dither");
+    polesParamPtr = apvts.getRawParameterValue("poles");
+    engineParamPtr = apvts.getRawParameterValue("engine");
+    precisionParamPtr = apvts.getRawParameterValue("precision");
+    oversamplingParamPtr = apvts.getRawParameterValue("oversampling");
+    oversamplingModeParamPtr = apvts.getRawParameterValue("oversamplingMode");
+    governorParamPtr = apvts.getRawParameterValue("governor");
+    qualityTierParam = apvts.getParameter("qualityTier");
+
+    for (int i = 0; i < WeightAlphaState::numValues; ++i)
+        stateParameters[static_cast<size_t>(i)] = apvts.getParameter(WeightAlphaState::parameterIds[i]);
+
+    for (size_t i = 0; i < numProgramValues; ++i)
+        programParameters[i] = apvts.getParameter(programParameterIds[i]);
+
+    // Opt-in tracing: WEIGHTALPHA_TRACE=<file.json> records every instance in the process
+    if (const char* tracePath = std::getenv("WEIGHTALPHA_TRACE"))
+        tracing = WeightAlphaTrace::start(tracePath);
+
+    // Opt-in stats for Tools/WeightAlphaTelemetry: WEIGHTALPHA_TELEMETRY=1
+    const char* telemetrySetting = std::getenv("WEIGHTALPHA_TELEMETRY");
+    if (telemetrySetting != nullptr && std::strcmp(telemetrySetting, "1") == 0)
+        telemetry.open();
+
+    startTimerHz(30);
+}
+
+WeightAlphaProcessor::~WeightAlphaProcessor()
+{
+    stopTimer();
+
+    if (tracing)
+        WeightAlphaTrace::stop();
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout WeightAlphaProcessor::createParameterLayout()
@@ -37,19 +69,88 @@ juce::AudioProcessorValueTreeState::ParameterLayout WeightAlphaProcessor::create
         .withStringFromValueFunction([](float val, int) {
             return val > 0.5f ? "Narrow (20120 Hz)" : "Full (2020k Hz)";
             })));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("dither", 6), "Dither",
+        juce::StringArray{ "Off", "Airwindows", "TPDF" }, 1));
+    params.push_back(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID("poles", 7), "Poles", 1, WeightAlphaDSP::maxStages, WeightAlphaDSP::defaultStages));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("engine", 8), "Engine",
+        juce::StringArray{ "Recursive", "Block State-Space" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("precision", 9), "Precision",
+        juce::StringArray{ "Float", "Double State, Float I/O", "Double" }, 2));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("oversampling", 10), "Oversampling",
+        juce::StringArray{ "Off", "2x", "4x", "8x" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("oversamplingMode", 10), "Oversampling Mode",
+        juce::StringArray{ "Always", "Offline Only" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("governor", 11), "Adaptive Quality", false));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("qualityTier", 11), "Quality Tier",
+        juce::StringArray{ "Full", "Reduced", "Economy" }, 0,
+        juce::AudioParameterChoiceAttributes()
+        .withAutomatable(false)
+        .withCategory(juce::AudioProcessorParameter::otherMeter)));
     return { params.begin(), params.end() };
 }
 
-void WeightAlphaProcessor::prepareToPlay(double, int)
+void WeightAlphaProcessor::prepareToPlay(double sampleRate, int)
 {
-    precisionProcessingFloat.prepare();
-    precisionProcessingDouble.prepare();
+    const auto seed = ditherSeed != 0 ? ditherSeed : static_cast<uint32_t>(juce::Random::getSystemRandom().nextInt());
+    governor.prepare(sampleRate, governorSettings);
+    core.prepare(sampleRate, getTotalNumOutputChannels(), seed, loadParameters());
+    coreLatency.store(core.getLatencySamples(), std::memory_order_relaxed);
+    setLatencySamples(core.getLatencySamples());
+}
+
+WeightAlphaDSP::Parameters WeightAlphaProcessor::loadParameters() const
+{
+    const uint32_t generation = programGeneration.load(std::memory_order_acquire);
+
+    WeightAlphaDSP::Parameters p;
+    p.freq = freqParamPtr->load(std::memory_order_relaxed);
+    p.weight = weightParamPtr->load(std::memory_order_relaxed);
+    p.strength = strengthParamPtr->load(std::memory_order_relaxed);
+    p.poles = juce::roundToInt(polesParamPtr->load(std::memory_order_relaxed));
+    p.stateSpace = engineParamPtr->load(std::memory_order_relaxed) > 0.5f;
+    p.bypass = bypassParamPtr->load(std::memory_order_relaxed) > 0.5f;
+    p.precision = static_cast<WeightAlphaDSP::Precision>(juce::roundToInt(precisionParamPtr->load(std::memory_order_relaxed)));
+
+    // "Offline Only" keeps real-time playback cheap and oversamples bounces
+    const bool offlineOnly = oversamplingModeParamPtr->load(std::memory_order_relaxed) > 0.5f;
+    if (!offlineOnly || isNonRealtime())
+        p.oversampling = 1 << juce::roundToInt(oversamplingParamPtr->load(std::memory_order_relaxed));
+    p.dither = static_cast<WeightAlphaDither::Mode>(juce::roundToInt(ditherParamPtr->load(std::memory_order_relaxed)));
+
+    // A program change is pending or overlapped these reads, so some values
+    // may be from the old program and some from the new one: take the new
+    // one's whole snapshot. Its last value, Freq Range, only sets the editor's
+    // knob range and has no counterpart here.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ((generation & 1) != 0 || programGeneration.load(std::memory_order_acquire) != generation)
+    {
+        const auto& values = programs[static_cast<size_t>(pendingProgram.load(std::memory_order_acquire))].values;
+        p.freq = values[0];
+        p.weight = values[1];
+        p.strength = values[2];
+        p.bypass = values[3] > 0.5f;
+    }
+
+    return p;
+}
+
+double WeightAlphaProcessor::getTailLengthSeconds() const
+{
+    return core.getTailLengthSeconds(loadParameters());
 }
 
 bool WeightAlphaProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-        && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any discrete layout works: each channel is just another SIMD lane
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     if (layouts.getMainOutputChannelSet() == layouts.getMainInputChannelSet())
@@ -61,69 +162,71 @@ bool WeightAlphaProcessor::isBusesLayoutSupported(const BusesLayout& layouts) co
 template<typename T>
 void WeightAlphaProcessor::processBlockT(juce::AudioBuffer<T>& buffer)
 {
+    const auto start = WeightAlphaDSP::QualityGovernor::Clock::now();
+    WeightAlphaRealtimeAudit::ScopedRealtimeContext realtime("processBlock");
+    WeightAlphaTrace::nameThisThread("audio");
+    WeightAlphaTrace::Scope trace("processBlock", "audio", "samples", buffer.getNumSamples());
     juce::ScopedNoDenormals noDenormals;
 
-    const bool bypass = bypassParamPtr->load(std::memory_order_relaxed) > 0.5f;
-    const float weightVal = weightParamPtr->load(std::memory_order_relaxed);
-    const float strengthVal = strengthParamPtr->load(std::memory_order_relaxed);
+    // A mono input feeding a wider output is spread across every output channel
+    if (getTotalNumInputChannels() == 1)
+        for (int ch = 1; ch < buffer.getNumChannels(); ++ch)
+            buffer.copyFrom(ch, 0, buffer, 0, 0, buffer.getNumSamples());
 
-    if (bypass || weightVal == 0.0f)
-        return;
+    // Offline renders have no deadline, so they always get full quality
+    const bool adaptive = isAdaptiveQualityOn() && !isNonRealtime();
+    if (!adaptive)
+        governor.reset();
 
-    const float freqVal = freqParamPtr->load(std::memory_order_relaxed);
+    const auto params = WeightAlphaDSP::QualityGovernor::apply(loadParameters(), governor.getTier());
+    core.setParameters(params);
+    coreLatency.store(core.getLatencySamples(), std::memory_order_relaxed);
 
-    auto& st = getPrecisionDependantProcessing<T>();
-    auto* channelDataL = buffer.getWritePointer(0);
-    auto* channelDataR = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+    core.process(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), buffer.getNumSamples());
 
-    double overallscale = getSampleRate() / 44100.0;
-    double targetFreq = juce::mapToLog10(freqVal, 20.0f, 20000.0f) / getSampleRate();
-    targetFreq = ((targetFreq + 0.53) * 0.2) / std::sqrt(overallscale);
+    const double seconds = std::chrono::duration<double>(WeightAlphaDSP::QualityGovernor::Clock::now() - start).count();
+    if (buffer.getNumSamples() > 0)
+        loadHistogram.record(seconds * getSampleRate() / buffer.getNumSamples());
 
-    double alpha = std::pow(targetFreq, 4);
-    double resControl = (weightVal * (0.05 + strengthVal * 0.1)) + (0.2 + strengthVal * 0.3);
-    double beta = alpha * (resControl * resControl);
-    alpha += (1.0 - beta) * std::pow(targetFreq, 3);
+    if (adaptive)
+        governor.update(seconds, buffer.getNumSamples());
 
-    for (int n = 0; n < buffer.getNumSamples(); ++n)
+    if (telemetry.isOpen())
     {
-        T dryL = channelDataL[n];
-        T dryR = channelDataR ? channelDataR[n] : dryL;
-        T xL = dryL;
-        T xR = dryR;
-
-        for (int i = 0; i < 8; ++i)
-        {
-            T trend = static_cast<T>(beta * (xL - st.prevL[i]) + (0.999 - beta) * st.trendL[i]);
-            T forecast = static_cast<T>(st.prevL[i] + st.trendL[i]);
-            xL = static_cast<T>(alpha * xL + (0.999 - alpha) * forecast);
-            st.prevL[i] = xL;
-            st.trendL[i] = trend;
-
-            trend = static_cast<T>(beta * (xR - st.prevR[i]) + (0.999 - beta) * st.trendR[i]);
-            forecast = static_cast<T>(st.prevR[i] + st.trendR[i]);
-            xR = static_cast<T>(alpha * xR + (0.999 - alpha) * forecast);
-            st.prevR[i] = xR;
-            st.trendR[i] = trend;
-        }
+        WeightAlphaTelemetry::BlockReport report;
+        report.processingNs = static_cast<uint64_t>(seconds * 1.0e9);
+        report.sampleRate = getSampleRate();
+        report.blockSize = buffer.getNumSamples();
+        report.numChannels = buffer.getNumChannels();
+        report.realtime = !isNonRealtime();
+        report.freqHz = juce::mapToLog10(params.freq, 20.0f, 20000.0f);
+        report.weight = params.weight;
+        report.strength = params.strength;
+        report.poles = params.poles;
+        report.oversampling = params.oversampling;
+        report.precision = static_cast<int>(params.precision);
+        report.qualityTier = static_cast<int>(governor.getTier());
+        report.bypass = params.bypass;
+        report.stateSpace = params.stateSpace;
+        telemetry.publish(report);
+    }
+}
 
-        xL = (xL * weightVal) + (dryL * (1.0f - weightVal));
-        xR = (xR * weightVal) + (dryR * (1.0f - weightVal));
+// Governor tiers share one latency, so only the Oversampling parameter moves
+// it; hosts re-align from their next block. Tier changes are seconds apart
+// and reach hosts like automation output.
+void WeightAlphaProcessor::timerCallback()
+{
+    applyPendingProgram();
 
-        if constexpr (std::is_same_v<T, float>)
-        {
-            int expon;
-            frexpf(xL, &expon);
-            st.fpdL ^= st.fpdL << 13; st.fpdL ^= st.fpdL >> 17; st.fpdL ^= st.fpdL << 5;
-            xL += static_cast<T>((static_cast<int32_t>(st.fpdL)) * 5.5e-36l * std::pow(2, expon + 62));
-
-            frexpf(xR, &expon);
-            st.fpdR ^= st.fpdR << 13; st.fpdR ^= st.fpdR >> 17; st.fpdR ^= st.fpdR << 5;
-            xR += static_cast<T>((static_cast<int32_t>(st.fpdR)) * 5.5e-36l * std::pow(2, expon + 62));
-        }
+    const int latency = coreLatency.load(std::memory_order_relaxed);
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
 
-        channelDataL[n] = xL;
-        if (channelDataR) channelDataR[n] = xR;
+    if (governor.getTier() != publishedTier)
+    {
+        publishedTier = governor.getTier();
+        qualityTierParam->setValueNotifyingHost(qualityTierParam->convertTo0to1(static_cast<float>(publishedTier)));
     }
 }
 
@@ -137,56 +240,86 @@ void WeightAlphaProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce:
     processBlockT(buffer);
 }
 
+template<typename T>
+void WeightAlphaProcessor::processOffline(juce::AudioBuffer<T>& buffer, int numThreads)
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    if (getTotalNumInputChannels() == 1)
+        for (int ch = 1; ch < buffer.getNumChannels(); ++ch)
+            buffer.copyFrom(ch, 0, buffer, 0, 0, buffer.getNumSamples());
+
+    core.setParameters(loadParameters());
+    core.processOffline(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), buffer.getNumSamples(), numThreads);
+}
+
+template void WeightAlphaProcessor::processOffline(juce::AudioBuffer<float>&, int);
+template void WeightAlphaProcessor::processOffline(juce::AudioBuffer<double>&, int);
+
 juce::AudioProcessorEditor* WeightAlphaProcessor::createEditor()
 {
     return new WeightAlphaEditor(*this);
 }
 
+const std::array<WeightAlphaProcessor::ProgramSnapshot, 3> WeightAlphaProcessor::programs{ {
+    { "Default",      { juce::mapFromLog10(120.0f, 20.0f, 20000.0f), 0.5f, 0.5f, 0.0f, 0.0f } },
+    { "Bass Boost",   { juce::mapFromLog10(80.0f, 20.0f, 20000.0f),  0.7f, 0.6f, 0.0f, 1.0f } },
+    { "Vocal Warmth", { juce::mapFromLog10(500.0f, 20.0f, 20000.0f), 0.4f, 0.4f, 0.0f, 0.0f } },
+} };
+
 int WeightAlphaProcessor::getCurrentProgram()
 {
-    return apvts.state.getProperty("currentProgram", 0);
+    return currentProgram.load(std::memory_order_relaxed);
 }
 
+// Hosts may call this from the audio thread, so it only publishes the
+// snapshot, which every block takes until its parameters are in place; the
+// audio never sees a mix of two programs. Writing the parameters notifies
+// the host and the listeners, which may lock, so that waits for the message
+// thread: at once when called there, else from the next timer callback. With
+// no message manager at all no timer will ever run, so it happens at once.
 void WeightAlphaProcessor::setCurrentProgram(int index)
 {
-    juce::ValueTree state = apvts.copyState();
-    state.setProperty("currentProgram", index, nullptr);
-    if (index == 0) // Default
-    {
-        state.setProperty("freq", juce::mapFromLog10(120.0f, 20.0f, 20000.0f), nullptr);
-        state.setProperty("weight", 0.5f, nullptr);
-        state.setProperty("strength", 0.5f, nullptr);
-        state.setProperty("bypass", 0.0f, nullptr);
-        state.setProperty("freqRange", 0.0f, nullptr);
-    }
-    else if (index == 1) // Bass Boost
-    {
-        state.setProperty("freq", juce::mapFromLog10(80.0f, 20.0f, 20000.0f), nullptr);
-        state.setProperty("weight", 0.7f, nullptr);
-        state.setProperty("strength", 0.6f, nullptr);
-        state.setProperty("bypass", 0.0f, nullptr);
-        state.setProperty("freqRange", 1.0f, nullptr);
-    }
-    else if (index == 2) // Vocal Warmth
+    WeightAlphaRealtimeAudit::ScopedCallbackContext realtime("setCurrentProgram");
+    WeightAlphaTrace::Scope trace("setCurrentProgram", "state", "program", index);
+
+    if (index < 0 || index >= getNumPrograms())
+        return;
+
+    pendingProgram.store(index, std::memory_order_relaxed);
+    currentProgram.store(index, std::memory_order_relaxed);
+
+    // Odd, and moved on even if a change was already pending
+    uint32_t generation = programGeneration.load(std::memory_order_relaxed);
+    while (!programGeneration.compare_exchange_weak(generation, (generation | 1) + 2, std::memory_order_release,
+                                                    std::memory_order_relaxed))
     {
-        state.setProperty("freq", juce::mapFromLog10(500.0f, 20.0f, 20000.0f), nullptr);
-        state.setProperty("weight", 0.4f, nullptr);
-        state.setProperty("strength", 0.4f, nullptr);
-        state.setProperty("bypass", 0.0f, nullptr);
-        state.setProperty("freqRange", 0.0f, nullptr);
     }
-    apvts.replaceState(state);
+
+    if (juce::MessageManager::getInstanceWithoutCreating() == nullptr || juce::MessageManager::existsAndIsCurrentThread())
+        applyPendingProgram();
+}
+
+void WeightAlphaProcessor::applyPendingProgram()
+{
+    const uint32_t generation = programGeneration.load(std::memory_order_acquire);
+    if ((generation & 1) == 0)
+        return;
+
+    const int index = pendingProgram.load(std::memory_order_relaxed);
+    const auto& values = programs[static_cast<size_t>(index)].values;
+
+    for (size_t i = 0; i < numProgramValues; ++i)
+        programParameters[i]->setValueNotifyingHost(programParameters[i]->convertTo0to1(values[i]));
+
+    // Fails if another change came in meanwhile; the next callback writes that one
+    uint32_t expected = generation;
+    programGeneration.compare_exchange_strong(expected, generation + 1, std::memory_order_release, std::memory_order_relaxed);
 }
 
 const juce::String WeightAlphaProcessor::getProgramName(int index)
 {
-    switch (index)
-    {
-    case 0: return "Default";
-    case 1: return "Bass Boost";
-    case 2: return "Vocal Warmth";
-    default: return "Unknown";
-    }
+    return index >= 0 && index < getNumPrograms() ? programs[static_cast<size_t>(index)].name : "Unknown";
 }
 
 void WeightAlphaProcessor::changeProgramName(int index, const juce::String& newName)
@@ -194,18 +327,50 @@ void WeightAlphaProcessor::changeProgramName(int index, const juce::String& newN
     juce::ignoreUnused(index, newName);
 }
 
+// Saved as the compact binary format in WeightAlphaState.h; sessions saved
+// as XML by earlier versions still load
 void WeightAlphaProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    WeightAlphaState::State state;
+    state.program = getCurrentProgram();
+    for (int i = 0; i < WeightAlphaState::numValues; ++i)
+    {
+        const auto* param = stateParameters[static_cast<size_t>(i)];
+        state.values[i] = param->convertFrom0to1(param->getValue());
+    }
+
+    uint8_t bytes[WeightAlphaState::maxSize];
+    destData.replaceAll(bytes, WeightAlphaState::write(state, bytes, sizeof(bytes)));
 }
 
 void WeightAlphaProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
+    WeightAlphaTrace::Scope trace("setStateInformation", "state", "bytes", sizeInBytes);
+
+    WeightAlphaState::State state;
+    if (WeightAlphaState::read(data, static_cast<size_t>(juce::jmax(0, sizeInBytes)), state))
+    {
+        // Parameters the blob predates go back to their defaults, as with XML
+        for (int i = 0; i < WeightAlphaState::numValues; ++i)
+        {
+            auto* param = stateParameters[static_cast<size_t>(i)];
+            param->setValueNotifyingHost(i < state.numStored ? param->convertTo0to1(state.values[i]) : param->getDefaultValue());
+        }
+        currentProgram.store(juce::jlimit(0, getNumPrograms() - 1, static_cast<int>(state.program)), std::memory_order_relaxed);
+        return;
+    }
+
+    // A damaged or newer binary state is not XML either; keep the current settings
+    if (WeightAlphaState::isBinary(data, static_cast<size_t>(juce::jmax(0, sizeInBytes))))
+        return;
+
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
     if (xmlState && xmlState->hasTagName(apvts.state.getType()))
+    {
         apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+        currentProgram.store(juce::jlimit(0, getNumPrograms() - 1, static_cast<int>(apvts.state.getProperty("currentProgram", 0))),
+            std::memory_order_relaxed);
+    }
 }
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -1,5 +1,12 @@
 #pragma once
 #include <JuceHeader.h>
+#include "WeightAlphaCore.h"
+#include "WeightAlphaGovernor.h"
+#include "WeightAlphaLoadMeter.h"
+#include "WeightAlphaRealtimeAudit.h"
+#include "WeightAlphaState.h"
+#include "WeightAlphaTelemetry.h"
+#include "WeightAlphaTrace.h"
 
 // Custom parameter class for flexible display and conversion
 struct CustomParameter : public juce::AudioParameterFloat
@@ -52,11 +59,11 @@ namespace juce
 }
 
 // The main audio processor for the "Weight Alpha" plugin
-class WeightAlphaProcessor : public juce::AudioProcessor
+class WeightAlphaProcessor : public juce::AudioProcessor, private juce::Timer
 {
 public:
     WeightAlphaProcessor();
-    ~WeightAlphaProcessor() override = default;
+    ~WeightAlphaProcessor() override;
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override {}
@@ -72,19 +79,48 @@ public:
     bool acceptsMidi() const override { return false; }
     bool producesMidi() const override { return false; }
     bool isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 0.0; }
+    double getTailLengthSeconds() const override;
 
-    int getNumPrograms() override { return 3; }
+    int getNumPrograms() override { return static_cast<int>(programs.size()); }
     int getCurrentProgram() override;
     void setCurrentProgram(int index) override;
     const juce::String getProgramName(int index) override;
     void changeProgramName(int index, const juce::String& newName) override;
 
+    // Writes a pending program change's parameters. The message thread does
+    // this by itself; a caller with no message loop running that owns the
+    // processor outright, like the command-line tools, calls it after
+    // setCurrentProgram() so the parameters it sets next are not overridden.
+    void applyPendingProgram();
+
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
     juce::AudioProcessorValueTreeState& getValueTree() { return apvts; }
 
+    // Lets hosts drive our crossfaded bypass instead of hard-switching around us
+    juce::AudioProcessorParameter* getBypassParameter() const override { return apvts.getParameter("bypass"); }
+
+    // Renders a whole file held in memory using every core, with the current
+    // parameters held fixed. For offline tools only, never the audio thread.
+    template<typename T>
+    void processOffline(juce::AudioBuffer<T>& buffer, int numThreads = 0);
+
+    // A non-zero seed makes the dither noise, and so every render, repeat
+    // bit for bit; 0 draws a fresh seed. Takes effect at the next prepareToPlay.
+    void setDitherSeed(uint32_t seed) { ditherSeed = seed; }
+
+    // Thresholds the adaptive governor works to, for tests that need it to
+    // change tier on cue. Takes effect at the next prepareToPlay.
+    void setGovernorSettings(const WeightAlphaDSP::GovernorSettings& settings) { governorSettings = settings; }
+
+    // Quality the adaptive governor currently processes at; safe to read from any thread
+    WeightAlphaDSP::QualityTier getQualityTier() const { return governor.getTier(); }
+    bool isAdaptiveQualityOn() const { return governorParamPtr->load(std::memory_order_relaxed) > 0.5f; }
+
+    // Every block's processing time against its deadline; read it with snapshots
+    const WeightAlphaDSP::LoadHistogram& getLoadHistogram() const { return loadHistogram; }
+
 private:
     juce::AudioProcessorValueTreeState apvts;
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
@@ -94,36 +130,65 @@ private:
     std::atomic<float>* strengthParamPtr = nullptr;
     std::atomic<float>* bypassParamPtr = nullptr;
     std::atomic<float>* freqRangeParamPtr = nullptr;
-
-    template<typename T>
-    struct PrecisionDependantProcessing
+    std::atomic<float>* ditherParamPtr = nullptr;
+    std::atomic<float>* polesParamPtr = nullptr;
+    std::atomic<float>* engineParamPtr = nullptr;
+    std::atomic<float>* precisionParamPtr = nullptr;
+    std::atomic<float>* oversamplingParamPtr = nullptr;
+    std::atomic<float>* oversamplingModeParamPtr = nullptr;
+    std::atomic<float>* governorParamPtr = nullptr;
+
+    // The parameters saved in the binary state, in WeightAlphaState::parameterIds order
+    std::array<juce::RangedAudioParameter*, WeightAlphaState::numValues> stateParameters{};
+
+    // A factory program's settings, computed once so that the audio thread
+    // can switch to them without allocating or locking; values are in
+    // programParameterIds order
+    static constexpr const char* programParameterIds[] = { "freq", "weight", "strength", "bypass", "freqRange" };
+    static constexpr size_t numProgramValues = sizeof(programParameterIds) / sizeof(programParameterIds[0]);
+
+    struct ProgramSnapshot
     {
-        std::array<T, 8> prevL{}, prevR{}, trendL{}, trendR{};
-        uint32_t fpdL{ 1 }, fpdR{ 1 };
-
-        void prepare()
-        {
-            juce::Random rng;
-            fpdL = static_cast<uint32_t>(rng.nextInt(juce::Range<int>(16386, std::numeric_limits<int>::max())));
-            fpdR = static_cast<uint32_t>(rng.nextInt(juce::Range<int>(16386, std::numeric_limits<int>::max())));
-        }
+        const char* name;
+        std::array<float, numProgramValues> values;
     };
 
-    PrecisionDependantProcessing<float> precisionProcessingFloat;
-    PrecisionDependantProcessing<double> precisionProcessingDouble;
+    static const std::array<ProgramSnapshot, 3> programs;
+    std::array<juce::RangedAudioParameter*, numProgramValues> programParameters{};
 
-    template<typename T>
-    PrecisionDependantProcessing<T>& getPrecisionDependantProcessing()
-    {
-        if constexpr (std::is_same_v<T, float>)
-            return precisionProcessingFloat;
-        else
-            return precisionProcessingDouble;
-    }
+    // From a program change until the message thread has written all of its
+    // parameters the generation is odd, and loadParameters() takes them from
+    // the pending snapshot instead. Every change moves the generation on, so
+    // the writer can tell whether another arrived while it was writing.
+    std::atomic<int> currentProgram{ 0 }, pendingProgram{ 0 };
+    std::atomic<uint32_t> programGeneration{ 0 };
+
+    // Read-only report of the governor's tier, for hosts
+    juce::RangedAudioParameter* qualityTierParam = nullptr;
+    WeightAlphaDSP::QualityTier publishedTier = WeightAlphaDSP::QualityTier::full;
+
+    // The core's latency as of the last block; the timer passes changes on to
+    // the host, since setLatencySamples() may lock and call back into it
+    std::atomic<int> coreLatency{ 0 };
+
+    // All signal processing lives in the JUCE-free core shared with the C API
+    WeightAlphaDSP::Core core;
+    uint32_t ditherSeed = 0;
+    bool tracing = false;
+    WeightAlphaDSP::QualityGovernor governor;
+    WeightAlphaDSP::GovernorSettings governorSettings;
+    WeightAlphaDSP::LoadHistogram loadHistogram;
+    WeightAlphaTelemetry::Publisher telemetry;
+
+    WeightAlphaDSP::Parameters loadParameters() const;
 
     template<typename T>
     void processBlockT(juce::AudioBuffer<T>& buffer);
 
+    // Message thread: finishes a program change made on another thread and
+    // reports what the audio thread published to the host
+    void timerCallback() override;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WeightAlphaProcessor)
 };
 
@@ -0,0 +1,371 @@
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+#include "WeightAlphaToolParameters.h"
+
+// Headless batch renderer: streams audio files through WeightAlphaProcessor
+// without ever creating an editor. Build it as a JUCE console application
+// together with PluginProcessor.cpp and PluginEditor.cpp.
+//
+//   WeightAlphaBatch [options] <input>...
+//   WeightAlphaBatch [options] --jobs <job file>
+//
+//   --out <dir>        output folder (default: "processed" next to each input)
+//   --threads <n>      worker threads, one processor each (default: all cores)
+//   --block <frames>   streaming block size (default: 65536)
+//   --preset <0-2>     start from a factory preset
+//   --freq <Hz> --weight <0-1> --strength <0-1> --poles <1-16>
+//   --dither <Off|Airwindows|TPDF> --engine <Recursive|Block State-Space>
+//   --oversampling <Off|2x|4x|8x> --oversamplingMode <Always|Offline Only>
+//   --whole-file       load each file completely and render it on all cores
+//   --isa <name>       force a kernel variant for every job
+//   --self-test        check the parameter handling on a worker thread and exit
+//
+// Each job file line is "<input> [output] [name=value ...]"; values on a line
+// override the command-line ones and '#' starts a comment. Jobs run
+// concurrently, so the process-wide isa cannot be set per line.
+namespace
+{
+    struct Job
+    {
+        juce::File input, output;
+        juce::StringPairArray params;
+        int preset = -1;
+
+        juce::int64 frames = 0;
+        double sampleRate = 0.0;
+        double seconds = 0.0;
+        juce::String error;
+    };
+
+    juce::String renderFile(WeightAlphaProcessor& processor, juce::AudioFormatManager& formats,
+        Job& job, int blockSize, bool wholeFile, int offlineThreads)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(job.input));
+        if (reader == nullptr)
+            return "cannot read input";
+
+        auto* format = formats.findFormatForFileExtension(job.output.getFileExtension());
+        if (format == nullptr)
+            return "unsupported output format";
+
+        const int numChannels = static_cast<int>(reader->numChannels);
+        job.frames = reader->lengthInSamples;
+        job.sampleRate = reader->sampleRate;
+
+        // AudioBuffer counts frames in int; longer files have to stream
+        if (wholeFile && job.frames > std::numeric_limits<int>::max())
+            return "too long for --whole-file (over 2^31 frames); render it without";
+
+        job.output.getParentDirectory().createDirectory();
+
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+        for (int bits : { static_cast<int>(reader->bitsPerSample), 24 })
+        {
+            job.output.deleteFile();
+            auto stream = job.output.createOutputStream();
+            if (stream == nullptr)
+                return "cannot create output";
+
+            writer.reset(format->createWriterFor(stream.get(), reader->sampleRate,
+                static_cast<unsigned int>(numChannels), bits, {}, 0));
+
+            if (writer != nullptr)
+            {
+                stream.release(); // now owned by the writer
+                break;
+            }
+        }
+
+        if (writer == nullptr)
+            return "output format rejects this channel count or bit depth";
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+        layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+        if (!processor.setBusesLayout(layout))
+            return "unsupported channel layout";
+
+        WeightAlphaTools::applyParameters(processor, job.preset, job.params);
+        processor.setNonRealtime(true);
+        processor.setRateAndBufferSizeDetails(reader->sampleRate, blockSize);
+        processor.prepareToPlay(reader->sampleRate, blockSize);
+
+        if (wholeFile)
+        {
+            juce::AudioBuffer<float> buffer(numChannels, static_cast<int>(job.frames));
+            reader->read(&buffer, 0, buffer.getNumSamples(), 0, true, true);
+            processor.processOffline(buffer, offlineThreads);
+            writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+        }
+        else
+        {
+            // Memory stays at one block per worker regardless of file length.
+            // Oversampling delays the output, so the first latency frames are
+            // dropped and the input is run on into as much silence.
+            juce::AudioBuffer<float> buffer(numChannels, blockSize);
+            juce::MidiBuffer midi;
+            const juce::int64 latency = processor.getLatencySamples();
+
+            for (juce::int64 pos = 0; pos < job.frames + latency; pos += blockSize)
+            {
+                const int numSamples = static_cast<int>(juce::jmin<juce::int64>(blockSize, job.frames + latency - pos));
+                buffer.setSize(numChannels, numSamples, false, false, true);
+                reader->read(&buffer, 0, numSamples, pos, true, true);
+                processor.processBlock(buffer, midi);
+
+                const int skip = static_cast<int>(juce::jlimit<juce::int64>(0, numSamples, latency - pos));
+                writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip);
+            }
+        }
+
+        processor.releaseResources();
+        return {};
+    }
+
+    // Empty, or what is wrong with the line: an unknown name, or one that
+    // cannot differ between jobs
+    juce::String parseParams(const juce::StringArray& tokens, int start, Job& job)
+    {
+        for (int i = start; i < tokens.size(); ++i)
+        {
+            const auto name = tokens[i].upToFirstOccurrenceOf("=", false, false).trim();
+            const auto value = tokens[i].fromFirstOccurrenceOf("=", false, false).trim();
+
+            if (name == "isa")
+                return "isa= is not allowed on a job line, use --isa";
+
+            if (name == "preset")
+                job.preset = value.getIntValue();
+            else if (WeightAlphaTools::isParameterName(name))
+                job.params.set(name, value);
+            else
+                return "unknown parameter " + name;
+        }
+
+        return {};
+    }
+
+    // One seeded block of a sine through processor, set up as a job would be
+    juce::AudioBuffer<float> renderTestBlock(WeightAlphaProcessor& processor, int preset, juce::StringPairArray params)
+    {
+        params.set("seed", "1");
+        WeightAlphaTools::applyParameters(processor, preset, params);
+        processor.setNonRealtime(true);
+        processor.setRateAndBufferSizeDetails(48000.0, 512);
+        processor.prepareToPlay(48000.0, 512);
+
+        juce::AudioBuffer<float> buffer(processor.getTotalNumOutputChannels(), 512);
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(ch, i, 0.5f * std::sin(0.05f * static_cast<float>(i)));
+
+        juce::MidiBuffer midi;
+        processor.processBlock(buffer, midi);
+        processor.releaseResources();
+        return buffer;
+    }
+
+    bool sameRender(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                if (std::abs(a.getSample(ch, i) - b.getSample(ch, i)) > 1.0e-5f)
+                    return false;
+
+        return true;
+    }
+
+    // Jobs set parameters on worker threads while the main thread waits, with
+    // no message loop running: an explicit value has to win over the preset,
+    // and the preset must not carry into the next job on the same processor
+    int selfTest()
+    {
+        int failures = 0;
+        std::thread worker([&] {
+            juce::StringPairArray weight;
+            weight.set("weight", "0.3");
+            juce::StringPairArray bassBoost = weight;
+            bassBoost.set("freq", "80");
+            bassBoost.set("strength", "0.6");
+
+            WeightAlphaProcessor reused, fresh;
+            const auto overridden = renderTestBlock(reused, 1, weight);
+            const auto expected = renderTestBlock(fresh, -1, bassBoost);
+            const bool flagWins = sameRender(overridden, expected);
+            std::cerr << "preset 1 --weight 0.3 renders as its values with weight 0.3  " << (flagWins ? "PASS" : "FAIL") << std::endl;
+
+            const auto next = renderTestBlock(reused, -1, weight);
+            const bool noCarry = sameRender(next, renderTestBlock(fresh, -1, weight));
+            std::cerr << "next job on the same processor ignores the preset          " << (noCarry ? "PASS" : "FAIL") << std::endl;
+
+            failures = (flagWins ? 0 : 1) + (noCarry ? 0 : 1);
+        });
+        worker.join();
+
+        std::cerr << failures << " failure(s)" << std::endl;
+        return failures == 0 ? 0 : 1;
+    }
+
+    juce::File defaultOutputFor(const juce::File& input, const juce::File& outDir)
+    {
+        const auto dir = outDir == juce::File() ? input.getParentDirectory().getChildFile("processed") : outDir;
+        return dir.getChildFile(input.getFileName());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::CharPointer_UTF8(argv[i]));
+
+    Job defaults;
+    juce::File outDir, jobFile;
+    juce::StringArray inputs;
+    int numThreads = juce::SystemStats::getNumCpus();
+    int blockSize = 65536;
+    bool wholeFile = false;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto& arg = args[i];
+        const auto next = [&] { return i + 1 < args.size() ? args[++i] : juce::String(); };
+
+        if (arg == "--out")                 outDir = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+        else if (arg == "--jobs")           jobFile = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+        else if (arg == "--threads")        numThreads = juce::jmax(1, next().getIntValue());
+        else if (arg == "--block")          blockSize = juce::jmax(16, next().getIntValue());
+        else if (arg == "--whole-file")     wholeFile = true;
+        else if (arg == "--self-test")      return selfTest();
+        else if (WeightAlphaTools::parseParameterOption(args, i, defaults.preset, defaults.params))
+            continue;
+        else if (arg.startsWith("--"))
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            return 1;
+        }
+        else
+            inputs.add(arg);
+    }
+
+    std::vector<Job> jobs;
+
+    for (const auto& input : inputs)
+    {
+        Job job = defaults;
+        job.input = juce::File::getCurrentWorkingDirectory().getChildFile(input);
+        job.output = defaultOutputFor(job.input, outDir);
+        jobs.push_back(job);
+    }
+
+    if (jobFile != juce::File())
+    {
+        juce::StringArray lines;
+        jobFile.readLines(lines);
+
+        for (auto line : lines)
+        {
+            line = line.upToFirstOccurrenceOf("#", false, false).trim();
+            if (line.isEmpty())
+                continue;
+
+            juce::StringArray tokens;
+            tokens.addTokens(line, " \t", "\"");
+            tokens.removeEmptyStrings();
+            tokens.trim();
+            for (auto& t : tokens)
+                t = t.unquoted();
+
+            Job job = defaults;
+            job.input = jobFile.getParentDirectory().getChildFile(tokens[0]);
+            int firstParam = 1;
+
+            if (tokens.size() > 1 && !tokens[1].containsChar('='))
+            {
+                job.output = jobFile.getParentDirectory().getChildFile(tokens[1]);
+                firstParam = 2;
+            }
+            else
+            {
+                job.output = defaultOutputFor(job.input, outDir);
+            }
+
+            const auto error = parseParams(tokens, firstParam, job);
+            if (error.isNotEmpty())
+            {
+                std::cerr << jobFile.getFileName() << ": " << error << ": " << line << std::endl;
+                return 1;
+            }
+
+            jobs.push_back(job);
+        }
+    }
+
+    if (jobs.empty())
+    {
+        std::cerr << "usage: WeightAlphaBatch [options] <input>... | --jobs <file>" << std::endl;
+        return 1;
+    }
+
+    numThreads = juce::jmin(numThreads, static_cast<int>(jobs.size()));
+    const int offlineThreads = juce::jmax(1, juce::SystemStats::getNumCpus() / numThreads);
+
+    // One processor per worker, created up front on the main thread; every
+    // job resets it, so a job's output does not depend on which worker ran it
+    std::vector<std::unique_ptr<WeightAlphaProcessor>> processors;
+    for (int t = 0; t < numThreads; ++t)
+        processors.push_back(std::make_unique<WeightAlphaProcessor>());
+
+    std::atomic<int> nextJob{ 0 };
+    std::vector<std::thread> workers;
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    for (int t = 0; t < numThreads; ++t)
+    {
+        workers.emplace_back([&, t] {
+            juce::AudioFormatManager formats;
+            formats.registerBasicFormats();
+
+            for (int index = nextJob++; index < static_cast<int>(jobs.size()); index = nextJob++)
+            {
+                auto& job = jobs[static_cast<size_t>(index)];
+                const auto jobStart = juce::Time::getMillisecondCounterHiRes();
+                job.error = renderFile(*processors[static_cast<size_t>(t)], formats, job, blockSize, wholeFile, offlineThreads);
+                job.seconds = (juce::Time::getMillisecondCounterHiRes() - jobStart) * 0.001;
+            }
+        });
+    }
+
+    for (auto& w : workers)
+        w.join();
+
+    const double wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+    double audioSeconds = 0.0;
+    int failures = 0;
+
+    for (const auto& job : jobs)
+    {
+        if (job.error.isNotEmpty())
+        {
+            ++failures;
+            std::cout << "FAILED  " << job.input.getFullPathName() << ": " << job.error << std::endl;
+            continue;
+        }
+
+        const double duration = job.sampleRate > 0.0 ? static_cast<double>(job.frames) / job.sampleRate : 0.0;
+        audioSeconds += duration;
+        std::cout << juce::String(job.seconds * 1000.0, 1) << " ms  "
+                  << juce::String(duration / juce::jmax(job.seconds, 1.0e-9), 1) << "x realtime  "
+                  << job.output.getFullPathName() << std::endl;
+    }
+
+    std::cout << jobs.size() - static_cast<size_t>(failures) << " files, " << failures << " failed, "
+              << juce::String(wallSeconds, 2) << " s wall, "
+              << juce::String(static_cast<double>(jobs.size()) / wallSeconds, 2) << " files/s, "
+              << juce::String(audioSeconds / wallSeconds, 1) << "x realtime overall, "
+              << numThreads << " workers" << std::endl;
+
+    return failures == 0 ? 0 : 2;
+}
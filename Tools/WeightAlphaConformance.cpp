@@ -0,0 +1,1048 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../WeightAlphaCore.h"
+#include "../WeightAlphaGovernor.h"
+#include "../WeightAlphaLoadMeter.h"
+#include "../WeightAlphaRealtimeAudit.h"
+#include "../WeightAlphaState.h"
+#include "../WeightAlphaRealtimeAuditHooks.inl"
+
+// Conformance harness: every optimised cascade path is checked against the
+// original scalar processBlockT loop (double coefficients, per-sample casts
+// to float or double state, eight stages generalised to the Poles value),
+// under every internal precision policy, each with its own fixed tolerance.
+// Plain C++17 with no JUCE, so it builds with nothing more than
+//
+//   c++ -std=c++17 -O2 -pthread Tools/WeightAlphaConformance.cpp -o WeightAlphaConformance
+//
+//   --rate <Hz>       sample rate (default 48000)
+//   --seconds <s>     length of every test signal (default 0.5)
+//   --block <frames>  block size for the streaming kernels (default 100,
+//                     deliberately not a multiple of the state-space block)
+//   --verbose         one line per frequency and input instead of the worst case
+//   --isa <name>      test only this kernel variant (default: every variant
+//                     this CPU supports)
+//   --policy <name>   test only this internal precision policy: float,
+//                     double-state or double
+//                     (default: all three)
+//
+// Dither is off for the kernel comparisons; with a fixed seed the dithered
+// output is instead checked for bit-exact repeatability, and its noise level
+// against the original generator. At 2x, 4x and 8x oversampling the
+// resampler round trip and the offline render's latency compensation are
+// checked as well, that silence puts the core to sleep, the quality
+// governor against simulated load and its tier changes for constant latency
+// and a bounded transient, and the binary plugin state format for round
+// trips and damaged input. Built
+// with -DWEIGHTALPHA_RT_AUDIT=1, it also fails if the audio path allocates,
+// locks or makes a blocking call (see WeightAlphaRealtimeAudit.h). Exit status is 1 if anything fails.
+namespace
+{
+    using Channels = std::vector<std::vector<double>>;
+
+    // M_PI is not standard C++; MSVC only defines it with _USE_MATH_DEFINES
+    constexpr double pi = 3.14159265358979323846;
+
+    struct Options
+    {
+        double sampleRate = 48000.0;
+        double seconds = 0.5;
+        int blockSize = 100;
+        bool verbose = false;
+        WeightAlphaDSP::Isa isa = WeightAlphaDSP::Isa::scalar;
+        WeightAlphaDSP::Precision precision = WeightAlphaDSP::Precision::pureDouble;
+    };
+
+    struct Case
+    {
+        double hz = 1000.0;
+        float weight = 0.7f;
+        float strength = 0.6f;
+        int poles = WeightAlphaDSP::defaultStages;
+        int numChannels = 2;
+        WeightAlphaDSP::Precision precision = WeightAlphaDSP::Precision::pureDouble;
+    };
+
+    struct Input
+    {
+        const char* name;
+        std::vector<double> data;
+    };
+
+    std::vector<Input> makeInputs(const Options& options)
+    {
+        const int n = static_cast<int>(options.sampleRate * options.seconds);
+        std::vector<Input> inputs{ { "impulse", {} }, { "sweep", {} }, { "noise", {} }, { "silence", {} } };
+
+        for (auto& input : inputs)
+            input.data.assign(static_cast<size_t>(n), 0.0);
+
+        inputs[0].data[0] = 1.0;
+
+        // Exponential sweep 20 Hz - 20 kHz (or Nyquist) at -6 dBFS
+        const double f0 = 20.0, f1 = std::min(20000.0, options.sampleRate * 0.45);
+        const double k = std::log(f1 / f0) / n;
+        for (int i = 0; i < n; ++i)
+            inputs[1].data[static_cast<size_t>(i)] = 0.5 * std::sin(2.0 * pi * f0 * (std::exp(k * i) - 1.0) / (k * options.sampleRate));
+
+        uint32_t x = 12345;
+        for (auto& v : inputs[2].data)
+        {
+            x = x * 1664525u + 1013904223u;
+            v = static_cast<double>(static_cast<int32_t>(x)) / 4294967296.0;
+        }
+
+        return inputs;
+    }
+
+    // Channel ch carries the input at a slightly different level so lanes differ
+    Channels spread(const std::vector<double>& input, int numChannels)
+    {
+        Channels channels(static_cast<size_t>(numChannels), input);
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (auto& v : channels[static_cast<size_t>(ch)])
+                v *= 1.0 - 0.1 * ch;
+        return channels;
+    }
+
+    // The original processBlockT, one channel at a time. It runs on the same
+    // alpha/beta as the optimised paths so that only the kernels are compared;
+    // the coefficient table is checked against pow separately.
+    template<typename T>
+    void processReference(Channels& channels, const Case& c, double sampleRate)
+    {
+        WeightAlphaDSP::CoefficientCache cache;
+        cache.prepare(sampleRate);
+        const auto k = cache.calculate(WeightAlphaDSP::Parameters::normalisedFrequency(c.hz), c.weight, c.strength);
+
+        for (auto& channel : channels)
+        {
+            std::vector<T> prev(static_cast<size_t>(c.poles), T(0)), trend(static_cast<size_t>(c.poles), T(0));
+
+            for (auto& sample : channel)
+            {
+                const T dry = static_cast<T>(sample);
+                T x = dry;
+
+                for (size_t i = 0; i < prev.size(); ++i)
+                {
+                    const T newTrend = static_cast<T>(k.beta * (x - prev[i]) + (0.999 - k.beta) * trend[i]);
+                    const T forecast = static_cast<T>(prev[i] + trend[i]);
+                    x = static_cast<T>(k.alpha * x + (0.999 - k.alpha) * forecast);
+                    prev[i] = x;
+                    trend[i] = newTrend;
+                }
+
+                sample = static_cast<double>((x * c.weight) + (dry * (1.0f - c.weight)));
+            }
+        }
+    }
+
+    double peak(const Channels& channels)
+    {
+        double max = 0.0;
+        for (const auto& channel : channels)
+            for (double v : channel)
+                max = std::max(max, std::abs(v));
+        return max;
+    }
+
+    void roundToFloat(Channels& channels)
+    {
+        for (auto& channel : channels)
+            for (auto& v : channel)
+                v = static_cast<float>(v);
+    }
+
+    // The reference for a case's precision policy: the original loop in float
+    // or double, with samples rounded through float on the way in and out
+    // when the path under test does that too
+    void processReference(Channels& channels, const Case& c, double sampleRate, bool floatIO)
+    {
+        if (!WeightAlphaDSP::usesDoubleState(c.precision))
+        {
+            processReference<float>(channels, c, sampleRate);
+            return;
+        }
+
+        if (floatIO)
+            roundToFloat(channels);
+
+        processReference<double>(channels, c, sampleRate);
+
+        if (floatIO)
+            roundToFloat(channels);
+    }
+
+    template<typename T>
+    std::vector<std::vector<T>> toPrecision(const Channels& channels)
+    {
+        std::vector<std::vector<T>> out;
+        for (const auto& channel : channels)
+            out.emplace_back(channel.begin(), channel.end());
+        return out;
+    }
+
+    template<typename T>
+    Channels fromPrecision(const std::vector<std::vector<T>>& channels)
+    {
+        Channels out;
+        for (const auto& channel : channels)
+            out.emplace_back(channel.begin(), channel.end());
+        return out;
+    }
+
+    template<typename T>
+    std::vector<T*> pointersTo(std::vector<std::vector<T>>& channels)
+    {
+        std::vector<T*> pointers;
+        for (auto& channel : channels)
+            pointers.push_back(channel.data());
+        return pointers;
+    }
+
+    WeightAlphaDSP::Parameters parametersFor(const Case& c)
+    {
+        WeightAlphaDSP::Parameters p;
+        p.freq = WeightAlphaDSP::Parameters::normalisedFrequency(c.hz);
+        p.weight = c.weight;
+        p.strength = c.strength;
+        p.poles = c.poles;
+        p.dither = WeightAlphaDither::Mode::off;
+        p.precision = c.precision;
+        return p;
+    }
+
+    // Calls fn with a zero of the state type the case's policy computes in
+    template<typename Fn>
+    void withStateType(const Case& c, Fn&& fn)
+    {
+        if (WeightAlphaDSP::usesDoubleState(c.precision))
+            fn(0.0);
+        else
+            fn(0.0f);
+    }
+
+    // Each kernel renders the signal in place at precision T
+    template<typename T>
+    using Kernel = std::function<void(std::vector<std::vector<T>>&, const Case&, const Options&)>;
+
+    template<typename T>
+    void runRecursive(std::vector<std::vector<T>>& channels, const Case& c, const Options& options)
+    {
+        WeightAlphaDSP::CoefficientCache cache;
+        cache.prepare(options.sampleRate);
+        const auto p = parametersFor(c);
+        const auto ramp = WeightAlphaDSP::ControlRamp::constant(cache.calculate(p.freq, p.weight, p.strength), p.weight);
+        const bool floatIO = c.precision == WeightAlphaDSP::Precision::doubleStateFloatIO;
+        auto pointers = pointersTo(channels);
+        const int n = static_cast<int>(channels[0].size());
+
+        withStateType(c, [&](auto zero) {
+            WeightAlphaDSP::CascadeState<decltype(zero)> st;
+            st.prepare(c.numChannels, options.isa);
+
+            for (int start = 0; start < n; start += options.blockSize)
+                WeightAlphaDSP::processCascade(st, pointers.data(), c.numChannels, start,
+                    std::min(options.blockSize, n - start), ramp, c.poles, 1, floatIO);
+            });
+    }
+
+    template<typename T>
+    void runStateSpace(std::vector<std::vector<T>>& channels, const Case& c, const Options& options)
+    {
+        WeightAlphaDSP::CoefficientCache cache;
+        cache.prepare(options.sampleRate);
+        const auto p = parametersFor(c);
+        auto engine = std::make_unique<WeightAlphaDSP::StateSpaceEngine>();
+        engine->setCoefficients(cache.calculate(p.freq, p.weight, p.strength), p.weight, c.poles);
+        auto pointers = pointersTo(channels);
+        const int n = static_cast<int>(channels[0].size());
+
+        withStateType(c, [&](auto zero) {
+            WeightAlphaDSP::CascadeState<decltype(zero)> st;
+            st.prepare(c.numChannels, options.isa);
+
+            for (int start = 0; start < n; start += options.blockSize)
+                engine->process(st, pointers.data(), c.numChannels, start, std::min(options.blockSize, n - start));
+            });
+    }
+
+    template<typename T>
+    void runCoreInterleaved(std::vector<std::vector<T>>& channels, const Case& c, const Options& options)
+    {
+        auto core = std::make_unique<WeightAlphaDSP::Core>();
+        core->prepare(options.sampleRate, c.numChannels, 1, parametersFor(c));
+
+        const int n = static_cast<int>(channels[0].size());
+        std::vector<T> interleaved(static_cast<size_t>(n * c.numChannels));
+        for (int i = 0; i < n; ++i)
+            for (int ch = 0; ch < c.numChannels; ++ch)
+                interleaved[static_cast<size_t>(i * c.numChannels + ch)] = channels[static_cast<size_t>(ch)][static_cast<size_t>(i)];
+
+        for (int start = 0; start < n; start += options.blockSize)
+            core->processInterleaved(interleaved.data() + start * c.numChannels, c.numChannels, std::min(options.blockSize, n - start));
+
+        for (int i = 0; i < n; ++i)
+            for (int ch = 0; ch < c.numChannels; ++ch)
+                channels[static_cast<size_t>(ch)][static_cast<size_t>(i)] = interleaved[static_cast<size_t>(i * c.numChannels + ch)];
+    }
+
+    template<typename T>
+    void runCoreStateSpace(std::vector<std::vector<T>>& channels, const Case& c, const Options& options)
+    {
+        auto core = std::make_unique<WeightAlphaDSP::Core>();
+        auto p = parametersFor(c);
+        p.stateSpace = true;
+        core->prepare(options.sampleRate, c.numChannels, 1, p);
+
+        std::vector<T*> pointers(static_cast<size_t>(c.numChannels));
+        const int n = static_cast<int>(channels[0].size());
+
+        for (int start = 0; start < n; start += options.blockSize)
+        {
+            for (int ch = 0; ch < c.numChannels; ++ch)
+                pointers[static_cast<size_t>(ch)] = channels[static_cast<size_t>(ch)].data() + start;
+            core->process(pointers.data(), c.numChannels, std::min(options.blockSize, n - start));
+        }
+    }
+
+    template<typename T>
+    void runOffline(std::vector<std::vector<T>>& channels, const Case& c, const Options& options)
+    {
+        auto core = std::make_unique<WeightAlphaDSP::Core>();
+        core->prepare(options.sampleRate, c.numChannels, 1, parametersFor(c));
+        auto pointers = pointersTo(channels);
+        core->processOffline(pointers.data(), c.numChannels, static_cast<int64_t>(channels[0].size()), 4);
+    }
+
+    struct KernelSpec
+    {
+        const char* name;
+        Kernel<float> runFloat;
+        Kernel<double> runDouble;
+        // Runs through the dispatched SIMD kernels, so every variant is tested
+        bool perIsa;
+        // Rounds samples through float under the double-state policy; the
+        // block state-space engine reads and writes its buffers as they are
+        bool roundsFloatIO;
+    };
+
+    struct Error
+    {
+        double max = 0.0, sumSquares = 0.0, allowed = 0.0;
+        size_t count = 0;
+
+        void add(const Channels& a, const Channels& b)
+        {
+            for (size_t ch = 0; ch < a.size(); ++ch)
+                for (size_t i = 0; i < a[ch].size(); ++i)
+                {
+                    const double d = std::abs(a[ch][i] - b[ch][i]);
+                    max = std::isfinite(d) ? std::max(max, d) : HUGE_VAL;
+                    sumSquares += std::isfinite(d) ? d * d : 0.0;
+                    ++count;
+                }
+        }
+
+        double rms() const { return count > 0 ? std::sqrt(sumSquares / static_cast<double>(count)) : 0.0; }
+    };
+
+    // Max error allowed against the reference as a fraction of its peak, fixed
+    // per precision policy. Float state runs on float coefficients where the
+    // reference loop uses double ones, which 16 poles near Nyquist amplify to
+    // ~1.5e-4. Samples that pass through float at the edges may round a tie
+    // the other way: up to one float step at the peak. Double paths keep the
+    // original harness's 1e-9.
+    double toleranceFor(WeightAlphaDSP::Precision precision, bool floatIO)
+    {
+        switch (precision)
+        {
+        case WeightAlphaDSP::Precision::pureFloat:          return 5.0e-4;
+        case WeightAlphaDSP::Precision::doubleStateFloatIO: return floatIO ? 2.5e-7 : 1.0e-9;
+        case WeightAlphaDSP::Precision::pureDouble:         return floatIO ? 2.5e-7 : 1.0e-9;
+        }
+        return 0.0;
+    }
+
+    template<typename T>
+    Error compare(const KernelSpec& kernel, const Kernel<T>& run, const Case& c, const Input& input, const Options& options)
+    {
+        const bool floatIO = std::is_same_v<T, float>
+            || (kernel.roundsFloatIO && c.precision == WeightAlphaDSP::Precision::doubleStateFloatIO);
+
+        auto signal = toPrecision<T>(spread(input.data, c.numChannels));
+        auto expected = fromPrecision(signal);
+        processReference(expected, c, options.sampleRate, floatIO);
+        run(signal, c, options);
+
+        Error e;
+        e.add(expected, fromPrecision(signal));
+        e.allowed = toleranceFor(c.precision, floatIO) * peak(expected);
+        return e;
+    }
+
+    // Renders noise through the float path with dither on; equal seeds must
+    // give identical bits and different seeds different noise
+    bool checkDeterminism(const Options& options)
+    {
+        const auto render = [&](uint32_t seed) {
+            Case c;
+            auto p = parametersFor(c);
+            p.dither = WeightAlphaDither::Mode::airwindows;
+            auto core = std::make_unique<WeightAlphaDSP::Core>();
+            core->prepare(options.sampleRate, c.numChannels, seed, p);
+
+            auto signal = toPrecision<float>(spread(makeInputs(options)[2].data, c.numChannels));
+            auto pointers = pointersTo(signal);
+            core->process(pointers.data(), c.numChannels, static_cast<int>(signal[0].size()));
+            return signal;
+        };
+
+        const bool same = render(1234) == render(1234);
+        const bool differs = render(1234) != render(4321);
+        std::printf("determinism    seed repeat %s, seed change %s\n", same ? "identical" : "DIFFERS", differs ? "differs" : "IDENTICAL");
+        return same && differs;
+    }
+
+    // Every kernel variant must give the same bits as the portable one, with a
+    // parameter change mid-signal and dither on, so a render does not depend
+    // on the machine it ran on
+    bool checkIsaAgreement(const Options& options, const std::vector<WeightAlphaDSP::Isa>& isas)
+    {
+        const auto render = [&](WeightAlphaDSP::Isa isa, WeightAlphaDSP::Precision policy, auto zero, int oversampling) {
+            using T = decltype(zero);
+            Case c;
+            c.numChannels = 6;
+            c.precision = policy;
+            auto p = parametersFor(c);
+            p.dither = WeightAlphaDither::Mode::airwindows;
+            p.oversampling = oversampling;
+
+            WeightAlphaDSP::setIsaOverride(isa);
+            auto core = std::make_unique<WeightAlphaDSP::Core>();
+            core->prepare(options.sampleRate, c.numChannels, 99, p);
+
+            auto signal = toPrecision<T>(spread(makeInputs(options)[2].data, c.numChannels));
+            std::vector<T*> pointers(static_cast<size_t>(c.numChannels));
+            const int n = static_cast<int>(signal[0].size());
+
+            for (int start = 0; start < n; start += options.blockSize)
+            {
+                if (start >= n / 2 && p.freq != 0.8f)
+                {
+                    p.freq = 0.8f;
+                    p.weight = 0.3f;
+                    core->setParameters(p);
+                }
+
+                for (int ch = 0; ch < c.numChannels; ++ch)
+                    pointers[static_cast<size_t>(ch)] = signal[static_cast<size_t>(ch)].data() + start;
+                core->process(pointers.data(), c.numChannels, std::min(options.blockSize, n - start));
+            }
+
+            return signal;
+        };
+
+        bool pass = true;
+
+        for (auto isa : isas)
+        {
+            for (int i = 0; i < WeightAlphaDSP::numPrecisions; ++i)
+            {
+                const auto policy = static_cast<WeightAlphaDSP::Precision>(i);
+                const bool same = render(isa, policy, 0.0f, 1) == render(WeightAlphaDSP::Isa::scalar, policy, 0.0f, 1)
+                    && render(isa, policy, 0.0, 1) == render(WeightAlphaDSP::Isa::scalar, policy, 0.0, 1);
+                std::printf("isa agreement  %-6s %-12s vs scalar %s\n", WeightAlphaDSP::isaName(isa),
+                    WeightAlphaDSP::precisionName(policy), same ? "identical" : "DIFFERS");
+                pass &= same;
+            }
+
+            // 8x runs all three half-band stages through the resampler kernels
+            const auto policy = WeightAlphaDSP::Precision::pureDouble;
+            const bool same = render(isa, policy, 0.0f, 8) == render(WeightAlphaDSP::Isa::scalar, policy, 0.0f, 8)
+                && render(isa, policy, 0.0, 8) == render(WeightAlphaDSP::Isa::scalar, policy, 0.0, 8);
+            std::printf("isa agreement  %-6s 8x resampler vs scalar %s\n", WeightAlphaDSP::isaName(isa),
+                same ? "identical" : "DIFFERS");
+            pass &= same;
+        }
+
+        return pass;
+    }
+
+    // Table-based coefficients against the pow formula across the Freq range
+    bool checkCoefficients(const Options& options)
+    {
+        WeightAlphaDSP::CoefficientCache cache;
+        cache.prepare(options.sampleRate);
+        double worst = 0.0;
+
+        for (int i = 0; i <= 1000; ++i)
+        {
+            const float freq = static_cast<float>(i) / 1000.0f;
+            for (float weight : { 0.0f, 0.5f, 1.0f })
+                for (float strength : { 0.0f, 0.5f, 1.0f })
+                {
+                    const auto fast = cache.calculate(freq, weight, strength);
+                    const auto exact = WeightAlphaDSP::computeCoefficients(20.0 * std::pow(1000.0, static_cast<double>(freq)),
+                        options.sampleRate, weight, strength);
+                    worst = std::max({ worst, std::abs(fast.alpha / exact.alpha - 1.0), std::abs(fast.beta / exact.beta - 1.0) });
+                }
+        }
+
+        const bool pass = worst < 1.0e-6;
+        std::printf("coefficients   max relative error vs pow %.3e  %s\n", worst, pass ? "PASS" : "FAIL");
+        return pass;
+    }
+
+    // Noise level of the Airwindows dither against the original one-generator
+    // frexpf/pow code, measured on silence-adjacent material where it matters
+    bool checkDitherLevel(const Options& options)
+    {
+        const int n = static_cast<int>(options.sampleRate * options.seconds);
+        std::vector<float> signal(static_cast<size_t>(n));
+        for (int i = 0; i < n; ++i)
+            signal[static_cast<size_t>(i)] = 1.0e-3f * std::sin((static_cast<float>(i) + 0.5f) * 0.01f); // no exact zeros
+
+        double originalPower = 0.0, optimisedPower = 0.0;
+        uint32_t fpd = 17;
+
+        for (float x : signal)
+        {
+            int expon;
+            std::frexp(x, &expon);
+            fpd ^= fpd << 13; fpd ^= fpd >> 17; fpd ^= fpd << 5;
+            const float dithered = x + static_cast<float>(static_cast<int32_t>(fpd) * 5.5e-36L * std::pow(2, expon + 62));
+            const double noise = static_cast<double>(dithered) - x;
+            originalPower += noise * noise;
+        }
+
+        WeightAlphaDither::State st;
+        uint32_t seed = 17;
+        st.prepare(1, [&seed] { return seed = seed * 1664525u + 1013904223u; });
+        auto dithered = signal;
+        float* channel = dithered.data();
+        WeightAlphaDither::process(st, WeightAlphaDither::Mode::airwindows, &channel, 1, n);
+
+        for (int i = 0; i < n; ++i)
+        {
+            const double noise = static_cast<double>(dithered[static_cast<size_t>(i)]) - signal[static_cast<size_t>(i)];
+            optimisedPower += noise * noise;
+        }
+
+        // The scale must be frexp's 2^e exactly, denormals included
+        bool exact = true;
+        for (float x : { 0.0f, 1.0e-45f, 3.0e-43f, 1.0e-39f, 1.1754942e-38f, 1.17549435e-38f, -2.5e-20f, 0.75f, 1.0f, 3.0e5f })
+        {
+            int expon;
+            std::frexp(x, &expon);
+            exact &= WeightAlphaDither::detail::exponentScale(x) == std::ldexp(1.0f, expon);
+        }
+
+        const double ratio = std::sqrt(optimisedPower / originalPower);
+        const bool pass = std::abs(ratio - 1.0) < 0.1 && exact;
+        std::printf("dither level   optimised/original RMS %.3f, exponent scale %s  %s\n", ratio, exact ? "exact" : "WRONG",
+            pass ? "PASS" : "FAIL");
+        return pass;
+    }
+
+    // At every oversampling factor: with Weight at 0 the resampler round trip
+    // must return the input delayed by exactly the reported latency, and the
+    // latency-compensated offline render must line up with streaming
+    bool checkOversampling(const Options& options)
+    {
+        const int n = static_cast<int>(options.sampleRate * options.seconds);
+        std::vector<double> sine(static_cast<size_t>(n));
+        for (int i = 0; i < n; ++i)
+            sine[static_cast<size_t>(i)] = 0.5 * std::sin(2.0 * pi * 1000.0 * i / options.sampleRate);
+
+        bool pass = true;
+
+        for (int factor : { 2, 4, 8 })
+        {
+            Case c;
+            auto p = parametersFor(c);
+            p.oversampling = factor;
+
+            const auto stream = [&](float weight) {
+                auto q = p;
+                q.weight = weight;
+                auto core = std::make_unique<WeightAlphaDSP::Core>();
+                core->prepare(options.sampleRate, c.numChannels, 1, q);
+
+                auto signal = spread(sine, c.numChannels);
+                std::vector<double*> pointers(static_cast<size_t>(c.numChannels));
+
+                for (int start = 0; start < n; start += options.blockSize)
+                {
+                    for (int ch = 0; ch < c.numChannels; ++ch)
+                        pointers[static_cast<size_t>(ch)] = signal[static_cast<size_t>(ch)].data() + start;
+                    core->process(pointers.data(), c.numChannels, std::min(options.blockSize, n - start));
+                }
+
+                return std::make_pair(signal, core->getLatencySamples());
+            };
+
+            const auto [dry, latency] = stream(0.0f);
+            const auto [wet, wetLatency] = stream(c.weight);
+
+            auto core = std::make_unique<WeightAlphaDSP::Core>();
+            core->prepare(options.sampleRate, c.numChannels, 1, p);
+            auto offline = spread(sine, c.numChannels);
+            auto pointers = pointersTo(offline);
+            core->processOffline(pointers.data(), c.numChannels, n, 4);
+
+            // The sine's onset rings through the half-bands for about one
+            // more latency, so the dry comparison starts after that
+            double dryError = 0.0, offlineError = 0.0;
+            for (int i = latency; i < n; ++i)
+            {
+                const auto index = static_cast<size_t>(i);
+                if (i >= 2 * latency)
+                    dryError = std::max(dryError, std::abs(dry[0][index] - sine[index - static_cast<size_t>(latency)]));
+                offlineError = std::max(offlineError, std::abs(wet[0][index] - offline[0][index - static_cast<size_t>(wetLatency)]));
+            }
+
+            const bool ok = latency == WeightAlphaDSP::Oversampler::latencyFor(factor) && dryError < 1.0e-5 && offlineError < 1.0e-9;
+            std::printf("oversampling   %dx latency %d, dry error %.3e, offline vs streaming %.3e  %s\n", factor, latency,
+                dryError, offlineError, ok ? "PASS" : "FAIL");
+            pass &= ok;
+        }
+
+        return pass;
+    }
+
+    // Loud full-size blocks, then silence in smaller ones: at every factor the
+    // core must fall asleep once the filters have rung out, whatever the
+    // larger blocks left in the resampler's spare chunk space
+    bool checkSilenceSleep(const Options& options)
+    {
+        bool pass = true;
+
+        for (int factor : { 1, 2, 4, 8 })
+        {
+            Case c;
+            auto p = parametersFor(c);
+            p.oversampling = factor;
+            auto core = std::make_unique<WeightAlphaDSP::Core>();
+            core->prepare(options.sampleRate, c.numChannels, 1, p);
+
+            const int loudBlock = WeightAlphaDSP::Oversampler::maxChunk, quietBlock = 64;
+            Channels block(static_cast<size_t>(c.numChannels), std::vector<double>(static_cast<size_t>(loudBlock)));
+            auto pointers = pointersTo(block);
+            uint32_t x = 1;
+
+            for (int b = 0; b < 40; ++b)
+            {
+                for (auto& channel : block)
+                    for (auto& v : channel)
+                        v = static_cast<double>(static_cast<int32_t>(x = x * 1664525u + 1013904223u)) / 2147483648.0;
+                core->process(pointers.data(), c.numChannels, loudBlock);
+            }
+
+            int quietFrames = 0;
+            const int limit = static_cast<int>(2.0 * options.sampleRate);
+            for (; quietFrames < limit && !core->isSleeping(); quietFrames += quietBlock)
+            {
+                for (auto& channel : block)
+                    std::fill(channel.begin(), channel.end(), 0.0);
+                core->process(pointers.data(), c.numChannels, quietBlock);
+            }
+
+            const bool ok = core->isSleeping();
+            const auto when = ok ? "asleep after " + std::to_string(quietFrames) + " silent frames" : std::string("never asleep");
+            std::printf("silence sleep  %dx %s  %s\n", factor, when.c_str(), ok ? "PASS" : "FAIL");
+            pass &= ok;
+        }
+
+        return pass;
+    }
+
+    // Feeds the quality governor simulated block timings: sustained load must
+    // step it down one tier at a time, a long quiet spell step it back up, and
+    // a step up that is undone at once must double the wait for the next one
+    bool checkGovernor(const Options& options)
+    {
+        using WeightAlphaDSP::QualityTier;
+        WeightAlphaDSP::QualityGovernor governor;
+        governor.prepare(options.sampleRate);
+
+        const int blockSize = 256;
+        const auto run = [&](double load, double seconds) {
+            const double blockSeconds = blockSize / options.sampleRate;
+            for (double t = 0.0; t < seconds; t += blockSeconds)
+                governor.update(load * blockSeconds, blockSize);
+            return governor.getTier();
+        };
+
+        const bool down = run(0.8, 0.9) == QualityTier::reduced && run(0.8, 0.5) == QualityTier::economy;
+        const bool holds = run(0.1, 2.5) == QualityTier::economy && run(0.1, 1.0) == QualityTier::reduced;
+        const bool backsOff = run(0.8, 0.5) == QualityTier::economy && run(0.1, 4.0) == QualityTier::economy
+            && run(0.1, 3.0) == QualityTier::reduced;
+
+        const auto economy = WeightAlphaDSP::QualityGovernor::apply(parametersFor(Case{}), QualityTier::economy);
+        const bool applies = economy.oversampling == 1 && economy.poles <= 4 && !usesDoubleState(economy.precision)
+            && WeightAlphaDSP::Core::latencyFor(economy) == WeightAlphaDSP::Core::latencyFor(parametersFor(Case{}));
+
+        const bool pass = down && holds && backsOff && applies;
+        std::printf("governor       step down %s, hysteresis %s, back-off %s  %s\n", down ? "ok" : "WRONG",
+            holds ? "ok" : "WRONG", backsOff ? "ok" : "WRONG", pass ? "PASS" : "FAIL");
+        return pass;
+    }
+
+    // A governor tier change mid-stream, full to reduced and back, at every
+    // oversampling factor: the reported latency must not move, and the output
+    // must stay near the envelope of the two tiers' steady renders. The
+    // cascade state carried across rates is approximate, so stepping down
+    // leaves a small transient that dies away; a state reset rang to about
+    // two thirds of the peak here.
+    bool checkTierTransition(const Options& options)
+    {
+        using WeightAlphaDSP::QualityGovernor;
+        using WeightAlphaDSP::QualityTier;
+        const int n = static_cast<int>(options.sampleRate);
+        const int switchAt = n / 2;
+        std::vector<double> input(static_cast<size_t>(n));
+        for (int i = 0; i < n; ++i)
+        {
+            const double t = 2.0 * pi * i / options.sampleRate;
+            input[static_cast<size_t>(i)] = 0.5 * std::sin(700.0 * t) + 0.3 * std::sin(1300.0 * t);
+        }
+
+        bool pass = true;
+
+        for (int factor : { 2, 4, 8 })
+        {
+            Case c;
+            auto p = parametersFor(c);
+            p.oversampling = factor;
+            const auto full = QualityGovernor::apply(p, QualityTier::full);
+            const auto reduced = QualityGovernor::apply(p, QualityTier::reduced);
+
+            const auto stream = [&](const WeightAlphaDSP::Parameters& from, const WeightAlphaDSP::Parameters& to, bool& latencyHeld) {
+                auto core = std::make_unique<WeightAlphaDSP::Core>();
+                core->prepare(options.sampleRate, 1, 1, from);
+                const int latency = core->getLatencySamples();
+                auto signal = input;
+
+                for (int start = 0; start < n; start += options.blockSize)
+                {
+                    if (start >= switchAt)
+                        core->setParameters(to);
+                    double* pointer = signal.data() + start;
+                    core->process(&pointer, 1, std::min(options.blockSize, n - start));
+                    latencyHeld &= core->getLatencySamples() == latency;
+                }
+
+                return signal;
+            };
+
+            bool latencyHeld = true;
+            const auto steadyFull = stream(full, full, latencyHeld);
+            const auto steadyReduced = stream(reduced, reduced, latencyHeld);
+            const auto down = stream(full, reduced, latencyHeld);
+            const auto up = stream(reduced, full, latencyHeld);
+
+            double level = 0.0, excursion = 0.0;
+            for (int i = n / 4; i < n; ++i)
+            {
+                const auto index = static_cast<size_t>(i);
+                const double lo = std::min(steadyFull[index], steadyReduced[index]);
+                const double hi = std::max(steadyFull[index], steadyReduced[index]);
+                level = std::max(level, std::max(std::abs(lo), std::abs(hi)));
+                for (double v : { down[index], up[index] })
+                    excursion = std::max(excursion, std::max(lo - v, v - hi));
+            }
+
+            excursion /= level;
+            const bool ok = latencyHeld && excursion < 0.15;
+            std::printf("tier switch    %dx latency %s, excursion %.3e of peak  %s\n", factor, latencyHeld ? "held" : "MOVED",
+                excursion, ok ? "PASS" : "FAIL");
+            pass &= ok;
+        }
+
+        return pass;
+    }
+
+    // The binary state must round-trip exactly, reject truncated, corrupted
+    // and newer blobs, and read an older, shorter one with later values absent
+    bool checkStateFormat()
+    {
+        using namespace WeightAlphaState;
+        State state;
+        state.program = 2;
+        for (int i = 0; i < numValues; ++i)
+            state.values[i] = 0.1f * static_cast<float>(i) - 0.37f;
+
+        uint8_t bytes[maxSize];
+        const size_t size = write(state, bytes, sizeof(bytes));
+
+        State back;
+        bool roundTrip = size == maxSize && read(bytes, size, back) && back.program == state.program
+            && back.numStored == numValues && std::memcmp(back.values, state.values, sizeof(state.values)) == 0;
+
+        State untouched;
+        bool rejects = !read(bytes, size - 1, untouched) && !read(bytes, 3, untouched) && !read(nullptr, 0, untouched);
+        for (size_t i = 0; i < size; ++i)
+        {
+            bytes[i] ^= 0x10;
+            rejects &= !read(bytes, size, untouched) && untouched.program == 0;
+            bytes[i] ^= 0x10;
+        }
+
+        // An older build's blob: two fewer values, re-checksummed
+        uint8_t older[maxSize];
+        std::memcpy(older, bytes, sizeof(older));
+        const int olderCount = numValues - 2;
+        older[6] = static_cast<uint8_t>(olderCount);
+        older[7] = 0;
+        detail::put32(older + sizeFor(olderCount) - 4, detail::checksum(older, sizeFor(olderCount) - 4));
+        State fromOlder;
+        const bool readsOlder = read(older, sizeFor(olderCount), fromOlder) && fromOlder.numStored == olderCount
+            && std::memcmp(fromOlder.values, state.values, sizeof(float) * olderCount) == 0;
+
+        // A newer version is refused even with a valid checksum
+        bytes[4] = static_cast<uint8_t>(version + 1);
+        detail::put32(bytes + size - 4, detail::checksum(bytes, size - 4));
+        rejects &= !read(bytes, size, untouched) && isBinary(bytes, size);
+
+        const bool pass = roundTrip && rejects && readsOlder;
+        std::printf("state format   %zu bytes, round trip %s, damaged input %s, older blob %s  %s\n", size,
+            roundTrip ? "ok" : "WRONG", rejects ? "rejected" : "ACCEPTED", readsOlder ? "ok" : "WRONG", pass ? "PASS" : "FAIL");
+        return pass;
+    }
+
+    // Streams audio through the core inside a real-time context while every
+    // parameter, including precision, engine and oversampling, changes between
+    // blocks of varying size, together with the governor and load meter the
+    // plugin runs each block, and quality tiers switch with the oversampled
+    // path crossfading against the padded one. Any allocation, lock or
+    // blocking call counts against it; without the audit build there is
+    // nothing to check.
+    bool checkRealtimeSafety(const Options& options)
+    {
+#if WEIGHTALPHA_RT_AUDIT
+        using WeightAlphaDSP::Precision;
+        const int numChannels = 2, maxBlock = 2048;
+
+        WeightAlphaRealtimeAudit::prepare();
+        WeightAlphaDSP::Parameters p;
+        WeightAlphaDSP::Core core;
+        core.prepare(options.sampleRate, numChannels, 1, p);
+        WeightAlphaDSP::QualityGovernor governor;
+        governor.prepare(options.sampleRate);
+        WeightAlphaDSP::LoadHistogram histogram;
+
+        Channels doubles(numChannels, std::vector<double>(maxBlock));
+        std::vector<std::vector<float>> floatBuffer(numChannels, std::vector<float>(maxBlock));
+        auto doublePointers = pointersTo(doubles);
+        auto floatPointers = pointersTo(floatBuffer);
+
+        const Precision precisions[] = { Precision::pureFloat, Precision::doubleStateFloatIO, Precision::pureDouble };
+        const WeightAlphaDither::Mode dithers[] = { WeightAlphaDither::Mode::off, WeightAlphaDither::Mode::airwindows };
+
+        WeightAlphaRealtimeAudit::resetViolationCount();
+        uint32_t x = 1;
+        int blocks = 0;
+
+        for (int factor : { 1, 2, 4, 8 })
+            for (int step = 0; step < 48; ++step, ++blocks)
+            {
+                const int n = 1 + static_cast<int>((x = x * 1664525u + 1013904223u) >> 8) % maxBlock;
+                p.freq = static_cast<float>(step % 7) / 6.0f;
+                p.weight = step % 11 == 0 ? 0.0f : 0.7f;
+                p.strength = static_cast<float>(step % 5) / 4.0f;
+                p.poles = 1 + step % WeightAlphaDSP::maxStages;
+                p.stateSpace = step % 3 == 0;
+                p.bypass = step % 13 == 0;
+                p.dither = dithers[step % 2];
+                p.precision = precisions[step % 3];
+                p.oversampling = step < 24 ? factor : 1;
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    for (int i = 0; i < n; ++i)
+                    {
+                        const double v = step % 4 == 3 ? 0.0 : 0.5 * std::sin(0.05 * i + ch);
+                        doubles[static_cast<size_t>(ch)][static_cast<size_t>(i)] = v;
+                        floatBuffer[static_cast<size_t>(ch)][static_cast<size_t>(i)] = static_cast<float>(v);
+                    }
+
+                // Tier changes every few blocks, often before the last one's
+                // crossfade is over, on top of whatever the governor measures
+                const auto forced = static_cast<WeightAlphaDSP::QualityTier>(step / 3 % WeightAlphaDSP::numQualityTiers);
+                const auto tier = std::max(forced, governor.getTier());
+
+                WeightAlphaRealtimeAudit::ScopedRealtimeContext realtime("processBlock");
+                const auto start = WeightAlphaDSP::QualityGovernor::Clock::now();
+                core.setParameters(WeightAlphaDSP::QualityGovernor::apply(p, tier));
+                if (step % 2 == 0)
+                    core.process(floatPointers.data(), numChannels, n);
+                else
+                    core.process(doublePointers.data(), numChannels, n);
+                governor.update(start, WeightAlphaDSP::QualityGovernor::Clock::now(), n);
+                histogram.record(governor.getLoad());
+            }
+
+        const auto violations = WeightAlphaRealtimeAudit::getViolationCount();
+        std::printf("realtime audit %d blocks, %llu violation(s)  %s\n", blocks,
+            static_cast<unsigned long long>(violations), violations == 0 ? "PASS" : "FAIL");
+        return violations == 0;
+#else
+        (void) options;
+        std::printf("realtime audit not built (compile with -DWEIGHTALPHA_RT_AUDIT=1)\n");
+        return true;
+#endif
+    }
+
+    // Runs one kernel over both buffer types, every channel count, pole count,
+    // frequency and input; prints a line per group and returns the failures
+    int runKernel(const KernelSpec& kernel, const std::vector<Input>& inputs, const Options& options)
+    {
+        const char* isaName = WeightAlphaDSP::isaName(options.isa);
+        const char* policyName = WeightAlphaDSP::precisionName(options.precision);
+        int failures = 0;
+
+        for (bool isDouble : { false, true })
+            for (int numChannels : { 1, 2, 6 })
+                for (int poles : { 1, WeightAlphaDSP::defaultStages, WeightAlphaDSP::maxStages })
+                {
+                    Error worst;
+                    double worstRatio = -1.0;
+                    double worstHz = 0.0;
+                    const char* worstInput = "";
+                    bool failed = false;
+
+                    for (double hz : { 40.0, 1000.0, 12000.0 })
+                        for (const auto& input : inputs)
+                        {
+                            const Case c{ hz, 0.7f, 0.6f, poles, numChannels, options.precision };
+                            const auto e = isDouble ? compare(kernel, kernel.runDouble, c, input, options)
+                                                    : compare(kernel, kernel.runFloat, c, input, options);
+                            const bool ok = e.max <= e.allowed;
+                            failed |= !ok;
+
+                            if (options.verbose)
+                                std::printf("%-13s %-6s %-12s %-6s %3d %5d %8.0f %-8s %12.3e %12.3e %10.1e  %s\n", kernel.name,
+                                    isaName, policyName, isDouble ? "double" : "float", numChannels, poles, hz, input.name,
+                                    e.max, e.rms(), e.allowed, ok ? "PASS" : "FAIL");
+
+                            if (e.max / e.allowed >= worstRatio)
+                            {
+                                worstRatio = e.max / e.allowed;
+                                worst = e;
+                                worstHz = hz;
+                                worstInput = input.name;
+                            }
+                        }
+
+                    failures += failed ? 1 : 0;
+
+                    if (!options.verbose)
+                        std::printf("%-13s %-6s %-12s %-6s %3d %5d %8.0f %-8s %12.3e %12.3e %10.1e  %s\n", kernel.name,
+                            isaName, policyName, isDouble ? "double" : "float", numChannels, poles, worstHz, worstInput,
+                            worst.max, worst.rms(), worst.allowed, failed ? "FAIL" : "PASS");
+                }
+
+        return failures;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    std::vector<WeightAlphaDSP::Isa> isas;
+    std::vector<WeightAlphaDSP::Precision> policies;
+
+    for (int i = 0; i < WeightAlphaDSP::numPrecisions; ++i)
+        policies.push_back(static_cast<WeightAlphaDSP::Precision>(i));
+
+    for (int i = 0; i <= static_cast<int>(WeightAlphaDSP::detectIsa()); ++i)
+        isas.push_back(static_cast<WeightAlphaDSP::Isa>(i));
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : "0";
+
+        if (arg == "--rate")          { options.sampleRate = std::max(8000.0, std::atof(value)); ++i; }
+        else if (arg == "--seconds")  { options.seconds = std::max(0.01, std::atof(value)); ++i; }
+        else if (arg == "--block")    { options.blockSize = std::max(1, std::atoi(value)); ++i; }
+        else if (arg == "--verbose")  options.verbose = true;
+        else if (arg == "--isa")
+        {
+            WeightAlphaDSP::Isa isa;
+            if (!WeightAlphaDSP::parseIsa(value, isa) || static_cast<int>(isa) > static_cast<int>(WeightAlphaDSP::detectIsa()))
+            {
+                std::fprintf(stderr, "unknown or unsupported --isa %s (this CPU: up to %s)\n", value,
+                    WeightAlphaDSP::isaName(WeightAlphaDSP::detectIsa()));
+                return 1;
+            }
+            isas = { isa };
+            ++i;
+        }
+        else if (arg == "--policy")
+        {
+            WeightAlphaDSP::Precision policy;
+            if (!WeightAlphaDSP::parsePrecision(value, policy))
+            {
+                std::fprintf(stderr, "unknown --policy %s (float, double-state or double)\n", value);
+                return 1;
+            }
+            policies = { policy };
+            ++i;
+        }
+    }
+
+    const KernelSpec kernels[] = {
+        { "recursive",    runRecursive<float>,       runRecursive<double>,       true,  true },
+        { "statespace",   runStateSpace<float>,      runStateSpace<double>,      false, false },
+        { "core-ilv",     runCoreInterleaved<float>, runCoreInterleaved<double>, true,  true },
+        { "core-ss",      runCoreStateSpace<float>,  runCoreStateSpace<double>,  false, false },
+        { "offline",      runOffline<float>,         runOffline<double>,         false, false },
+    };
+
+    const auto inputs = makeInputs(options);
+    int failures = 0;
+
+    std::printf("%-13s %-6s %-12s %-6s %3s %5s %8s %-8s %12s %12s %10s\n",
+        "kernel", "isa", "policy", "buffer", "ch", "poles", "freq", "input", "max_err", "rms_err", "tolerance");
+
+    for (const auto& kernel : kernels)
+    {
+        for (auto isa : isas)
+        {
+            if (!kernel.perIsa && isa != isas.back())
+                continue;
+
+            // The core picks its variant through the override, the bare kernels through the state
+            options.isa = isa;
+            WeightAlphaDSP::setIsaOverride(isa);
+
+            for (auto policy : policies)
+            {
+                options.precision = policy;
+                failures += runKernel(kernel, inputs, options);
+            }
+        }
+    }
+
+    failures += checkCoefficients(options) ? 0 : 1;
+    failures += checkDeterminism(options) ? 0 : 1;
+    failures += checkDitherLevel(options) ? 0 : 1;
+    failures += checkIsaAgreement(options, isas) ? 0 : 1;
+    failures += checkOversampling(options) ? 0 : 1;
+    failures += checkSilenceSleep(options) ? 0 : 1;
+    failures += checkGovernor(options) ? 0 : 1;
+    failures += checkTierTransition(options) ? 0 : 1;
+    failures += checkStateFormat() ? 0 : 1;
+    failures += checkRealtimeSafety(options) ? 0 : 1;
+
+    std::printf("%d failure(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}
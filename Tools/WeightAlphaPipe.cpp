@@ -0,0 +1,228 @@
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+#include "WeightAlphaToolParameters.h"
+
+#if JUCE_WINDOWS
+ #include <fcntl.h>
+ #include <io.h>
+#endif
+
+// Streaming pipe mode: raw interleaved PCM in on stdin, processed by the same
+// WeightAlphaProcessor as the plugin, and written to stdout block by block.
+// Build it as a JUCE console application together with PluginProcessor.cpp
+// and PluginEditor.cpp.
+//
+//   arecord -f S24_3LE -c 2 -r 48000 -t raw | WeightAlphaPipe --format s24 --block 128 | aplay ...
+//   WeightAlphaPipe --rate 44100 --channels 1 --format f32 < in.raw > out.raw
+//
+//   --rate <Hz>              sample rate (default 48000)
+//   --channels <n>           interleaved channel count (default 2)
+//   --format <s16|s24|f32>   little-endian sample format (default f32)
+//   --block <frames>         frames per block (default 256)
+//   --<parameter id> <value> and --preset <n> as for WeightAlphaBatch
+//
+// Everything is allocated before the first block; the streaming loop itself
+// only reads, converts, processes and writes. Latency and per-block timing go
+// to stderr when stdin closes.
+namespace
+{
+    enum class SampleFormat { s16, s24, f32 };
+
+    int bytesPerSample(SampleFormat format)
+    {
+        return format == SampleFormat::s16 ? 2 : (format == SampleFormat::s24 ? 3 : 4);
+    }
+
+    void deinterleave(const uint8_t* src, SampleFormat format, float* const* dest, int numChannels, int numFrames)
+    {
+        const int stride = bytesPerSample(format);
+
+        for (int n = 0; n < numFrames; ++n)
+        {
+            for (int ch = 0; ch < numChannels; ++ch, src += stride)
+            {
+                float value;
+
+                if (format == SampleFormat::s16)
+                    value = static_cast<float>(static_cast<int16_t>(src[0] | (src[1] << 8))) * (1.0f / 32768.0f);
+                else if (format == SampleFormat::s24)
+                {
+                    // Assembled unsigned so the top byte never shifts into an int's sign bit
+                    const uint32_t bits = static_cast<uint32_t>(src[0]) << 8 | static_cast<uint32_t>(src[1]) << 16
+                                        | static_cast<uint32_t>(src[2]) << 24;
+                    value = static_cast<float>(static_cast<int32_t>(bits) >> 8) * (1.0f / 8388608.0f);
+                }
+                else
+                    std::memcpy(&value, src, sizeof(value));
+
+                dest[ch][n] = value;
+            }
+        }
+    }
+
+    void interleave(const float* const* src, SampleFormat format, uint8_t* dest, int numChannels, int numFrames)
+    {
+        const int stride = bytesPerSample(format);
+
+        for (int n = 0; n < numFrames; ++n)
+        {
+            for (int ch = 0; ch < numChannels; ++ch, dest += stride)
+            {
+                const float value = src[ch][n];
+
+                if (format == SampleFormat::s16)
+                {
+                    const auto i = static_cast<int16_t>(juce::jlimit(-32768, 32767, juce::roundToInt(value * 32768.0f)));
+                    dest[0] = static_cast<uint8_t>(i & 0xff);
+                    dest[1] = static_cast<uint8_t>((i >> 8) & 0xff);
+                }
+                else if (format == SampleFormat::s24)
+                {
+                    const int32_t i = juce::jlimit(-8388608, 8388607, juce::roundToInt(value * 8388608.0f));
+                    dest[0] = static_cast<uint8_t>(i & 0xff);
+                    dest[1] = static_cast<uint8_t>((i >> 8) & 0xff);
+                    dest[2] = static_cast<uint8_t>((i >> 16) & 0xff);
+                }
+                else
+                {
+                    std::memcpy(dest, &value, sizeof(value));
+                }
+            }
+        }
+    }
+
+    // Blocks until the buffer is full or the stream ends; returns bytes read
+    size_t readFully(uint8_t* dest, size_t numBytes)
+    {
+        size_t total = 0;
+
+        while (total < numBytes)
+        {
+            const auto got = std::fread(dest + total, 1, numBytes - total, stdin);
+            if (got == 0)
+                break;
+            total += got;
+        }
+
+        return total;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+#if JUCE_WINDOWS
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::CharPointer_UTF8(argv[i]));
+
+    double sampleRate = 48000.0;
+    int numChannels = 2;
+    int blockSize = 256;
+    auto format = SampleFormat::f32;
+    int preset = -1;
+    juce::StringPairArray params;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto arg = args[i];
+        const auto next = [&] { return i + 1 < args.size() ? args[++i] : juce::String(); };
+
+        if (arg == "--rate")            sampleRate = juce::jmax(8000.0, next().getDoubleValue());
+        else if (arg == "--channels")   numChannels = juce::jmax(1, next().getIntValue());
+        else if (arg == "--block")      blockSize = juce::jmax(1, next().getIntValue());
+        else if (arg == "--format")
+        {
+            const auto name = next();
+            if (name == "s16")          format = SampleFormat::s16;
+            else if (name == "s24")     format = SampleFormat::s24;
+            else if (name == "f32")     format = SampleFormat::f32;
+            else
+            {
+                std::cerr << "unknown --format " << name << ", expected s16, s24 or f32" << std::endl;
+                return 1;
+            }
+        }
+        else if (!WeightAlphaTools::parseParameterOption(args, i, preset, params))
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    WeightAlphaProcessor processor;
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    if (!processor.setBusesLayout(layout))
+    {
+        std::cerr << "unsupported channel count " << numChannels << std::endl;
+        return 1;
+    }
+
+    WeightAlphaTools::applyParameters(processor, preset, params);
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    const size_t frameBytes = static_cast<size_t>(numChannels * bytesPerSample(format));
+    std::vector<uint8_t> raw(frameBytes * static_cast<size_t>(blockSize));
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    juce::int64 blocks = 0, frames = 0, totalTicks = 0, maxTicks = 0;
+
+    for (;;)
+    {
+        const size_t got = readFully(raw.data(), raw.size());
+        const int numFrames = static_cast<int>(got / frameBytes);
+        if (numFrames == 0)
+            break;
+
+        // Shrinking only moves the end marker; the allocation is kept
+        buffer.setSize(numChannels, numFrames, false, false, true);
+        deinterleave(raw.data(), format, buffer.getArrayOfWritePointers(), numChannels, numFrames);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midi);
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+        interleave(buffer.getArrayOfReadPointers(), format, raw.data(), numChannels, numFrames);
+        std::fwrite(raw.data(), 1, static_cast<size_t>(numFrames) * frameBytes, stdout);
+        std::fflush(stdout);
+
+        totalTicks += elapsed;
+        maxTicks = juce::jmax(maxTicks, elapsed);
+        frames += numFrames;
+        ++blocks;
+
+        if (got < raw.size())
+            break;
+    }
+
+    processor.releaseResources();
+
+    if (blocks > 0)
+    {
+        const double blockMs = blockSize * 1000.0 / sampleRate;
+        const double pluginMs = processor.getLatencySamples() * 1000.0 / sampleRate;
+        const double avgMs = juce::Time::highResolutionTicksToSeconds(totalTicks) * 1000.0 / static_cast<double>(blocks);
+        const double maxMs = juce::Time::highResolutionTicksToSeconds(maxTicks) * 1000.0;
+
+        std::cerr << "WeightAlphaPipe: " << frames << " frames in " << blocks << " blocks" << std::endl
+                  << "  added latency: " << juce::String(blockMs + pluginMs + maxMs, 3) << " ms worst case ("
+                  << juce::String(blockMs, 3) << " ms block buffering + "
+                  << juce::String(pluginMs, 3) << " ms plugin latency + "
+                  << juce::String(maxMs, 3) << " ms processing)" << std::endl
+                  << "  per block: avg " << juce::String(avgMs * 1000.0, 1) << " us, max "
+                  << juce::String(maxMs * 1000.0, 1) << " us ("
+                  << juce::String(100.0 * avgMs / blockMs, 2) << "% of the block period on average)" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <vector>
+#include "../WeightAlphaTelemetry.h"
+
+// Lists every Weight Alpha instance this user runs with WEIGHTALPHA_TELEMETRY=1
+// from the shared telemetry segment, most expensive first. Plain C++17 with no JUCE:
+//
+//   c++ -std=c++17 -O2 Tools/WeightAlphaTelemetry.cpp -o WeightAlphaTelemetry   (add -lrt on older glibc)
+//
+//   --watch <s>   redraw every s seconds; load and xruns then cover that interval
+//   --all         include slots whose process has exited
+//
+// Columns: process id, slot, sample rate, block size, channels, load of the
+// last block and average load (processing time over audio time), last block
+// time, xruns (blocks that took longer than they last), then the settings.
+namespace
+{
+    struct Row
+    {
+        int slot;
+        WeightAlphaTelemetry::SlotSnapshot now;
+        double load, average;
+        uint64_t xruns;
+        bool alive;
+    };
+
+    const char* tierName(uint32_t tier)
+    {
+        static const char* const names[] = { "full", "reduced", "economy" };
+        return tier < 3 ? names[tier] : "?";
+    }
+
+    const char* precisionName(uint32_t precision)
+    {
+        static const char* const names[] = { "float", "dbl-state", "double" };
+        return precision < 3 ? names[precision] : "?";
+    }
+
+    void print(const std::vector<Row>& rows)
+    {
+        std::printf("%7s %4s %6s %5s %3s %7s %7s %9s %6s %8s %6s %6s %5s %3s %-9s %-7s %s\n",
+            "pid", "slot", "rate", "block", "ch", "load%", "avg%", "block-us", "xruns",
+            "freq-Hz", "weight", "str", "poles", "os", "precision", "tier", "state");
+
+        double total = 0.0;
+
+        for (const auto& r : rows)
+        {
+            const auto& s = r.now;
+            const char* state = !r.alive ? "exited"
+                : (s.flags & WeightAlphaTelemetry::flagBypass) != 0 ? "bypassed"
+                : (s.flags & WeightAlphaTelemetry::flagStateSpace) != 0 ? "state-space" : "recursive";
+
+            std::printf("%7u %4d %6u %5u %3u %7.2f %7.2f %9.1f %6llu %8.1f %6.2f %6.2f %5u %3u %-9s %-7s %s\n",
+                s.owner, r.slot, s.sampleRate, s.blockSize, s.numChannels, r.load * 100.0, r.average * 100.0,
+                static_cast<double>(s.lastBlockNs) * 1.0e-3, static_cast<unsigned long long>(r.xruns),
+                s.freqHz, s.weight, s.strength, s.poles, s.oversampling, precisionName(s.precision),
+                tierName(s.qualityTier), state);
+
+            if (r.alive)
+                total += r.average;
+        }
+
+        std::printf("%zu instance(s), %.2f%% of one core in total\n", rows.size(), total * 100.0);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    double watchSeconds = 0.0;
+    bool all = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--watch") == 0 && i + 1 < argc)
+            watchSeconds = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--all") == 0)
+            all = true;
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--watch <seconds>] [--all]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    WeightAlphaTelemetry::Reader reader;
+    if (!reader.open())
+    {
+        std::printf("no Weight Alpha instances have published telemetry (WEIGHTALPHA_TELEMETRY=1) for this user since boot\n");
+        return 0;
+    }
+
+    // Previous snapshots by slot, so watch mode can report per-interval figures
+    std::map<int, WeightAlphaTelemetry::SlotSnapshot> previous;
+
+    for (;;)
+    {
+        std::vector<Row> rows;
+
+        for (int i = 0; i < WeightAlphaTelemetry::numSlots; ++i)
+        {
+            Row r{ i, {}, 0.0, 0.0, 0, false };
+            if (!reader.read(i, r.now))
+                continue;
+
+            r.alive = WeightAlphaTelemetry::Reader::isAlive(r.now);
+            if (!r.alive && !all)
+                continue;
+
+            const auto& s = r.now;
+            const double blockNs = s.sampleRate > 0 ? s.blockSize * 1.0e9 / s.sampleRate : 0.0;
+            r.load = blockNs > 0.0 ? static_cast<double>(s.lastBlockNs) / blockNs : 0.0;
+            r.average = s.audioNs > 0 ? static_cast<double>(s.busyNs) / static_cast<double>(s.audioNs) : 0.0;
+            r.xruns = s.xruns;
+
+            const auto before = previous.find(i);
+            if (watchSeconds > 0.0 && before != previous.end() && before->second.instanceId == s.instanceId)
+            {
+                const auto& p = before->second;
+                const auto audio = s.audioNs - p.audioNs;
+                r.average = audio > 0 ? static_cast<double>(s.busyNs - p.busyNs) / static_cast<double>(audio) : 0.0;
+                r.xruns = s.xruns - p.xruns;
+            }
+
+            previous[i] = s;
+            rows.push_back(r);
+        }
+
+        std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.average > b.average; });
+        print(rows);
+
+        if (!(watchSeconds > 0.0))
+            break;
+
+        std::fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::duration<double>(watchSeconds));
+        std::printf("\n");
+    }
+
+    return 0;
+}
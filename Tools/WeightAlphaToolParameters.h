@@ -0,0 +1,93 @@
+#pragma once
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+
+// Parameter handling shared by the command-line tools. Values are given by
+// parameter ID: freq in Hz, choices by name, everything else as a plain value
+// in the parameter's own range. "seed" fixes the dither noise so renders repeat.
+// --isa (scalar, sse2, avx2, avx512) forces a kernel variant for comparisons;
+// it switches the whole process, so it is a command-line option only.
+namespace WeightAlphaTools
+{
+    // True for the names applyParameters() understands
+    inline bool isParameterName(const juce::String& name)
+    {
+        if (name == "seed")
+            return true;
+
+        for (const char* id : WeightAlphaState::parameterIds)
+            if (name == id)
+                return true;
+
+        return false;
+    }
+
+    // Starts from every parameter's default and a fresh dither seed, so a
+    // processor reused for several jobs carries nothing from one to the next.
+    // The tools' main thread runs no message loop, so a preset's parameters
+    // are written here, before the explicit values that override them.
+    inline void applyParameters(WeightAlphaProcessor& processor, int preset, const juce::StringPairArray& params)
+    {
+        for (auto* param : processor.getParameters())
+            param->setValueNotifyingHost(param->getDefaultValue());
+        processor.setDitherSeed(0);
+
+        if (preset >= 0)
+        {
+            processor.setCurrentProgram(preset);
+            processor.applyPendingProgram();
+        }
+
+        auto& apvts = processor.getValueTree();
+        const auto& keys = params.getAllKeys();
+
+        for (const auto& key : keys)
+        {
+            auto* param = apvts.getParameter(key);
+            const auto text = params[key];
+
+            if (key == "seed")
+                processor.setDitherSeed(static_cast<uint32_t>(text.getLargeIntValue()));
+
+            if (param == nullptr)
+                continue;
+
+            if (key == "freq")
+                param->setValueNotifyingHost(juce::mapFromLog10(text.getFloatValue(), 20.0f, 20000.0f));
+            else if (text.containsAnyOf("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"))
+                param->setValueNotifyingHost(param->getValueForText(text));
+            else
+                param->setValueNotifyingHost(param->convertTo0to1(text.getFloatValue()));
+        }
+    }
+
+    // Consumes "--<id> <value>", "--preset <n>" or "--isa <name>" at args[i];
+    // call it after a tool has checked its own options, before any processing
+    // starts. Returns false if args[i] is none of these, an unknown id
+    // included, so that the tool can reject it.
+    inline bool parseParameterOption(const juce::StringArray& args, int& i, int& preset, juce::StringPairArray& params)
+    {
+        const auto arg = args[i];
+
+        if (!arg.startsWith("--") || i + 1 >= args.size())
+            return false;
+
+        if (arg != "--isa" && arg != "--preset" && !isParameterName(arg.substring(2)))
+            return false;
+
+        if (arg == "--isa")
+        {
+            WeightAlphaDSP::Isa isa;
+            if (WeightAlphaDSP::parseIsa(args[++i].toRawUTF8(), isa))
+                WeightAlphaDSP::setIsaOverride(isa);
+            else
+                std::cerr << "unknown --isa " << args[i] << ", ignored" << std::endl;
+        }
+        else if (arg == "--preset")
+            preset = args[++i].getIntValue();
+        else
+            params.set(arg.substring(2), args[++i]);
+
+        return true;
+    }
+}
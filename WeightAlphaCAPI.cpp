@@ -0,0 +1,159 @@
+#include "WeightAlphaCAPI.h"
+#include <new>
+#include "WeightAlphaCore.h"
+
+// C wrapper around WeightAlphaDSP::Core. Compiles without JUCE.
+struct WeightAlphaHandle
+{
+    WeightAlphaDSP::Core core;
+    WeightAlphaDSP::Parameters params;
+    bool prepared = false;
+};
+
+namespace
+{
+    // Denormals in the cascade tail cost far more than the filter itself;
+    // the plugin gets this from juce::ScopedNoDenormals
+    struct ScopedFlushDenormals
+    {
+#if WEIGHTALPHA_X86
+        ScopedFlushDenormals() : saved(_mm_getcsr()) { _mm_setcsr(saved | 0x8040); }
+        ~ScopedFlushDenormals() { _mm_setcsr(saved); }
+        unsigned int saved;
+#else
+        ScopedFlushDenormals() {}
+#endif
+    };
+
+    template<typename T>
+    int processPlanar(WeightAlphaHandle* handle, T* const* channels, int numChannels, int numFrames)
+    {
+        if (handle == nullptr || channels == nullptr || numChannels < 0 || numFrames < 0)
+            return WEIGHTALPHA_ERROR_INVALID_ARGUMENT;
+        if (!handle->prepared)
+            return WEIGHTALPHA_ERROR_NOT_PREPARED;
+
+        ScopedFlushDenormals flush;
+        handle->core.process(channels, numChannels, numFrames);
+        return WEIGHTALPHA_OK;
+    }
+
+    template<typename T>
+    int processInterleaved(WeightAlphaHandle* handle, T* data, int numChannels, int numFrames)
+    {
+        if (handle == nullptr || data == nullptr || numChannels <= 0 || numFrames < 0)
+            return WEIGHTALPHA_ERROR_INVALID_ARGUMENT;
+        if (!handle->prepared)
+            return WEIGHTALPHA_ERROR_NOT_PREPARED;
+
+        ScopedFlushDenormals flush;
+        handle->core.processInterleaved(data, numChannels, numFrames);
+        return WEIGHTALPHA_OK;
+    }
+}
+
+extern "C"
+{
+    WeightAlphaHandle* weightalpha_create(void)
+    {
+        return new (std::nothrow) WeightAlphaHandle();
+    }
+
+    void weightalpha_destroy(WeightAlphaHandle* handle)
+    {
+        delete handle;
+    }
+
+    int weightalpha_prepare(WeightAlphaHandle* handle, double sampleRate, int numChannels, uint32_t seed)
+    {
+        if (handle == nullptr || !(sampleRate > 0.0) || numChannels <= 0)
+            return WEIGHTALPHA_ERROR_INVALID_ARGUMENT;
+
+        handle->core.prepare(sampleRate, numChannels, seed, handle->params);
+        handle->prepared = true;
+        return WEIGHTALPHA_OK;
+    }
+
+    const char* weightalpha_get_isa(const WeightAlphaHandle* handle)
+    {
+        return handle != nullptr && handle->prepared ? WeightAlphaDSP::isaName(handle->core.getIsa()) : "";
+    }
+
+    int weightalpha_get_latency(const WeightAlphaHandle* handle)
+    {
+        return handle != nullptr && handle->prepared ? handle->core.getLatencySamples() : 0;
+    }
+
+    void weightalpha_reset(WeightAlphaHandle* handle)
+    {
+        if (handle != nullptr && handle->prepared)
+            handle->core.reset();
+    }
+
+    int weightalpha_set_parameter(WeightAlphaHandle* handle, WeightAlphaParameter parameter, double value)
+    {
+        if (handle == nullptr)
+            return WEIGHTALPHA_ERROR_INVALID_ARGUMENT;
+
+        auto& p = handle->params;
+
+        switch (parameter)
+        {
+        case WEIGHTALPHA_PARAM_FREQ_HZ:      p.freq = WeightAlphaDSP::Parameters::normalisedFrequency(value); break;
+        case WEIGHTALPHA_PARAM_WEIGHT:       p.weight = static_cast<float>(std::clamp(value, 0.0, 1.0)); break;
+        case WEIGHTALPHA_PARAM_STRENGTH:     p.strength = static_cast<float>(std::clamp(value, 0.0, 1.0)); break;
+        case WEIGHTALPHA_PARAM_POLES:        p.poles = std::clamp(static_cast<int>(std::lround(value)), 1, WeightAlphaDSP::maxStages); break;
+        case WEIGHTALPHA_PARAM_ENGINE:       p.stateSpace = value > 0.5; break;
+        case WEIGHTALPHA_PARAM_DITHER:       p.dither = static_cast<WeightAlphaDither::Mode>(std::clamp(static_cast<int>(std::lround(value)), 0, 2)); break;
+        case WEIGHTALPHA_PARAM_BYPASS:       p.bypass = value > 0.5; break;
+        case WEIGHTALPHA_PARAM_PRECISION:    p.precision = static_cast<WeightAlphaDSP::Precision>(std::clamp(static_cast<int>(std::lround(value)), 0, 2)); break;
+        case WEIGHTALPHA_PARAM_OVERSAMPLING: p.oversampling = WeightAlphaDSP::Oversampler::validFactor(static_cast<int>(std::lround(value))); break;
+        default: return WEIGHTALPHA_ERROR_INVALID_ARGUMENT;
+        }
+
+        handle->core.setParameters(p);
+        return WEIGHTALPHA_OK;
+    }
+
+    double weightalpha_get_parameter(const WeightAlphaHandle* handle, WeightAlphaParameter parameter)
+    {
+        if (handle == nullptr)
+            return 0.0;
+
+        const auto& p = handle->params;
+
+        switch (parameter)
+        {
+        case WEIGHTALPHA_PARAM_FREQ_HZ:      return 20.0 * std::pow(1000.0, static_cast<double>(p.freq));
+        case WEIGHTALPHA_PARAM_WEIGHT:       return p.weight;
+        case WEIGHTALPHA_PARAM_STRENGTH:     return p.strength;
+        case WEIGHTALPHA_PARAM_POLES:        return p.poles;
+        case WEIGHTALPHA_PARAM_ENGINE:       return p.stateSpace ? 1.0 : 0.0;
+        case WEIGHTALPHA_PARAM_DITHER:       return static_cast<double>(p.dither);
+        case WEIGHTALPHA_PARAM_BYPASS:       return p.bypass ? 1.0 : 0.0;
+        case WEIGHTALPHA_PARAM_PRECISION:    return static_cast<double>(p.precision);
+        case WEIGHTALPHA_PARAM_OVERSAMPLING: return p.oversampling;
+        default: return 0.0;
+        }
+    }
+
+    int weightalpha_process_planar_f32(WeightAlphaHandle* handle, float* const* channels, int numChannels, int numFrames)
+    {
+        return processPlanar(handle, channels, numChannels, numFrames);
+    }
+
+    int weightalpha_process_planar_f64(WeightAlphaHandle* handle, double* const* channels, int numChannels, int numFrames)
+    {
+        return processPlanar(handle, channels, numChannels, numFrames);
+    }
+
+    int weightalpha_process_interleaved_f32(WeightAlphaHandle* handle, float* data, int numChannels, int numFrames)
+    {
+        return processInterleaved(handle, data, numChannels, numFrames);
+    }
+
+    int weightalpha_process_interleaved_f64(WeightAlphaHandle* handle, double* data, int numChannels, int numFrames)
+    {
+        return processInterleaved(handle, data, numChannels, numFrames);
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef WEIGHTALPHA_CAPI_H
+#define WEIGHTALPHA_CAPI_H
+
+/* Plain C interface to the Weight Alpha DSP core for hosts that do not use
+   JUCE: streaming servers, game-audio middleware, other languages via FFI.
+   Build WeightAlphaCAPI.cpp (C++17, no JUCE) as a static or shared library.
+
+   All processing happens in place on caller-owned buffers, either planar
+   (one pointer per channel) or interleaved. Nothing is copied or allocated
+   per call; only weightalpha_create and weightalpha_prepare allocate.
+
+   A handle is not thread-safe: set parameters from the thread that calls
+   process, or between process calls. */
+
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(WEIGHTALPHA_BUILD_SHARED)
+ #define WEIGHTALPHA_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(WEIGHTALPHA_USE_SHARED)
+ #define WEIGHTALPHA_API __declspec(dllimport)
+#elif defined(__GNUC__)
+ #define WEIGHTALPHA_API __attribute__((visibility("default")))
+#else
+ #define WEIGHTALPHA_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct WeightAlphaHandle WeightAlphaHandle;
+
+typedef enum WeightAlphaParameter
+{
+    WEIGHTALPHA_PARAM_FREQ_HZ = 0,     /* 20 - 20000, default 120 */
+    WEIGHTALPHA_PARAM_WEIGHT = 1,      /* 0 - 1, default 0.5 */
+    WEIGHTALPHA_PARAM_STRENGTH = 2,    /* 0 - 1, default 0.5 */
+    WEIGHTALPHA_PARAM_POLES = 3,       /* 1 - 16, default 8 */
+    WEIGHTALPHA_PARAM_ENGINE = 4,      /* 0 recursive, 1 block state-space */
+    WEIGHTALPHA_PARAM_DITHER = 5,      /* 0 off, 1 Airwindows, 2 TPDF (float only) */
+    WEIGHTALPHA_PARAM_BYPASS = 6,      /* 0 or 1 */
+    WEIGHTALPHA_PARAM_PRECISION = 7,   /* 0 float, 1 double state with float I/O, 2 double */
+    WEIGHTALPHA_PARAM_OVERSAMPLING = 8 /* 1, 2, 4 or 8; see weightalpha_get_latency */
+} WeightAlphaParameter;
+
+enum
+{
+    WEIGHTALPHA_OK = 0,
+    WEIGHTALPHA_ERROR_INVALID_ARGUMENT = -1,
+    WEIGHTALPHA_ERROR_NOT_PREPARED = -2
+};
+
+WEIGHTALPHA_API WeightAlphaHandle* weightalpha_create(void);
+WEIGHTALPHA_API void weightalpha_destroy(WeightAlphaHandle* handle);
+
+/* Allocates per-channel state; call before processing and whenever the
+   sample rate or channel count changes. seed fixes the dither noise. */
+WEIGHTALPHA_API int weightalpha_prepare(WeightAlphaHandle* handle, double sampleRate, int numChannels, uint32_t seed);
+
+/* Instruction set the kernels were prepared with: "scalar", "sse2", "avx2"
+   or "avx512" ("" before prepare). The best one the CPU supports is used
+   unless the WEIGHTALPHA_ISA environment variable names another. */
+WEIGHTALPHA_API const char* weightalpha_get_isa(const WeightAlphaHandle* handle);
+
+/* Delay in frames the current oversampling adds to the output; changes
+   with WEIGHTALPHA_PARAM_OVERSAMPLING */
+WEIGHTALPHA_API int weightalpha_get_latency(const WeightAlphaHandle* handle);
+
+/* Clears the filter memory, e.g. when a stream restarts */
+WEIGHTALPHA_API void weightalpha_reset(WeightAlphaHandle* handle);
+
+/* Freq, weight and strength glide over 50 ms as in the plugin */
+WEIGHTALPHA_API int weightalpha_set_parameter(WeightAlphaHandle* handle, WeightAlphaParameter parameter, double value);
+WEIGHTALPHA_API double weightalpha_get_parameter(const WeightAlphaHandle* handle, WeightAlphaParameter parameter);
+
+/* Planar: channels[ch][n] for ch < numChannels, n < numFrames */
+WEIGHTALPHA_API int weightalpha_process_planar_f32(WeightAlphaHandle* handle, float* const* channels, int numChannels, int numFrames);
+WEIGHTALPHA_API int weightalpha_process_planar_f64(WeightAlphaHandle* handle, double* const* channels, int numChannels, int numFrames);
+
+/* Interleaved: data[n * numChannels + ch] */
+WEIGHTALPHA_API int weightalpha_process_interleaved_f32(WeightAlphaHandle* handle, float* data, int numChannels, int numFrames);
+WEIGHTALPHA_API int weightalpha_process_interleaved_f64(WeightAlphaHandle* handle, double* data, int numChannels, int numFrames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include "WeightAlphaTrace.h"
+
+// Cascade coefficients derived from the Freq/Weight/Strength parameters and
+// the sample rate. Free of JUCE like the rest of the DSP.
+namespace WeightAlphaDSP
+{
+    struct Coefficients
+    {
+        double alpha = 0.0;
+        double beta = 0.0;
+    };
+
+    // Reference implementation straight from the Airwindows formula; every
+    // call costs two pow and a sqrt. Used where exactness beats speed.
+    inline Coefficients computeCoefficients(double targetHz, double sampleRate, float weight, float strength)
+    {
+        const double overallscale = sampleRate / 44100.0;
+        double targetFreq = targetHz / sampleRate;
+        targetFreq = ((targetFreq + 0.53) * 0.2) / std::sqrt(overallscale);
+
+        Coefficients c;
+        c.alpha = std::pow(targetFreq, 4);
+        const double resControl = (weight * (0.05 + strength * 0.1)) + (0.2 + strength * 0.3);
+        c.beta = c.alpha * (resControl * resControl);
+        c.alpha += (1.0 - c.beta) * std::pow(targetFreq, 3);
+        return c;
+    }
+
+    // Number of samples until the impulse response of numStages identical
+    // stages falls below threshold for good, capped at maxSamples. With zero
+    // input each stage updates { prev, trend } by [[c, c], [-beta, d]]
+    // (c = 0.999 - alpha, d = 0.999 - beta); a cascade of S such stages decays
+    // like binomial(n + S - 1, S - 1) * r^n, r being the matrix' spectral radius.
+    inline double tailLengthSamples(const Coefficients& k, int numStages, double threshold, double maxSamples)
+    {
+        const double c = 0.999 - k.alpha, d = 0.999 - k.beta;
+        const double trace = c + d, det = c * d + c * k.beta;
+        const double disc = trace * trace - 4.0 * det;
+        const double r = disc < 0.0 ? std::sqrt(det) : 0.5 * (std::abs(trace) + std::sqrt(disc));
+
+        if (!(r < 1.0))
+            return maxSamples;
+        if (r <= 0.0)
+            return static_cast<double>(numStages);
+
+        const double logR = std::log(r), logThreshold = std::log(threshold);
+        const double s = static_cast<double>(std::max(1, numStages));
+        const auto logEnvelope = [&](double n) {
+            return std::lgamma(n + s) - std::lgamma(n + 1.0) - std::lgamma(s) + n * logR;
+        };
+
+        // Past the envelope's peak it only falls: bracket the crossing, then bisect
+        double lo = std::max(0.0, (s - 1.0) / -logR), hi = std::max(1.0, lo);
+        while (logEnvelope(hi) > logThreshold && hi < maxSamples)
+            hi *= 2.0;
+        if (hi >= maxSamples)
+            return maxSamples;
+
+        for (int i = 0; i < 60 && hi - lo > 1.0; ++i)
+        {
+            const double mid = 0.5 * (lo + hi);
+            (logEnvelope(mid) > logThreshold ? lo : hi) = mid;
+        }
+
+        return std::ceil(hi);
+    }
+
+    // Process-wide, read-only map from the normalised Freq value to Hz on the
+    // 20 Hz - 20 kHz log scale. This is the only transcendental in the
+    // coefficient formula and it does not depend on the sample rate, so one
+    // table serves every instance at every rate.
+    class FrequencyTable
+    {
+    public:
+        static constexpr int size = 4096;
+
+        // Built on first use; touch it from prepareToPlay, not the audio thread
+        static const FrequencyTable& get()
+        {
+            static const FrequencyTable table;
+            return table;
+        }
+
+        double hzFor(float normalised) const
+        {
+            const double pos = std::clamp(static_cast<double>(normalised), 0.0, 1.0) * size;
+            const int index = std::min(static_cast<int>(pos), size - 1);
+            const double frac = pos - index;
+            return hz[static_cast<size_t>(index)] + frac * (hz[static_cast<size_t>(index) + 1] - hz[static_cast<size_t>(index)]);
+        }
+
+    private:
+        FrequencyTable()
+        {
+            for (int i = 0; i <= size; ++i)
+                hz[static_cast<size_t>(i)] = 20.0 * std::pow(1000.0, static_cast<double>(i) / size);
+        }
+
+        std::array<double, size + 1> hz{};
+    };
+
+    // Per-instance cache: alpha/beta are only rebuilt when a parameter value
+    // or the sample rate actually changes, and then without pow or sqrt.
+    class CoefficientCache
+    {
+    public:
+        void prepare(double sampleRate)
+        {
+            table = &FrequencyTable::get();
+            invSampleRate = 1.0 / sampleRate;
+            freqScale = 0.2 / std::sqrt(sampleRate / 44100.0);
+            dirty = true;
+        }
+
+        const Coefficients& update(float freq, float weight, float strength)
+        {
+            if (dirty || freq != lastFreq || weight != lastWeight || strength != lastStrength)
+            {
+                coeffs = calculate(freq, weight, strength);
+                lastFreq = freq;
+                lastWeight = weight;
+                lastStrength = strength;
+                dirty = false;
+            }
+            return coeffs;
+        }
+
+        // Uncached evaluation, still table-based
+        Coefficients calculate(float freq, float weight, float strength) const
+        {
+            WeightAlphaTrace::Scope trace("coefficients", "dsp");
+            const double targetFreq = (table->hzFor(freq) * invSampleRate + 0.53) * freqScale;
+            const double targetFreq2 = targetFreq * targetFreq;
+            const double resControl = (weight * (0.05 + strength * 0.1)) + (0.2 + strength * 0.3);
+
+            Coefficients c;
+            c.alpha = targetFreq2 * targetFreq2;
+            c.beta = c.alpha * (resControl * resControl);
+            c.alpha += (1.0 - c.beta) * targetFreq2 * targetFreq;
+            return c;
+        }
+
+    private:
+        const FrequencyTable* table = &FrequencyTable::get();
+        double invSampleRate = 1.0 / 44100.0;
+        double freqScale = 0.2;
+        float lastFreq = 0.0f, lastWeight = 0.0f, lastStrength = 0.0f;
+        bool dirty = true;
+        Coefficients coeffs;
+    };
+}
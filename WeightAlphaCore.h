@@ -0,0 +1,722 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "WeightAlphaDSP.h"
+#include "WeightAlphaDither.h"
+#include "WeightAlphaOfflineRender.h"
+#include "WeightAlphaOversampling.h"
+#include "WeightAlphaSmoothing.h"
+#include "WeightAlphaStateSpace.h"
+
+// The complete Weight Alpha signal path (smoothing, cascade engines, dither)
+// behind one object that works directly on caller-owned buffers. The plugin,
+// the command-line tools and the C API in WeightAlphaCAPI.h all drive this
+// class; like the rest of the DSP it has no JUCE dependency.
+namespace WeightAlphaDSP
+{
+    struct Parameters
+    {
+        float freq = normalisedFrequency(120.0); // 20 Hz - 20 kHz log scale, 0-1
+        float weight = 0.5f;
+        float strength = 0.5f;
+        int poles = defaultStages;
+        bool stateSpace = false;
+        bool bypass = false;
+        WeightAlphaDither::Mode dither = WeightAlphaDither::Mode::airwindows;
+        Precision precision = Precision::pureDouble;
+        int oversampling = 1; // 1, 2, 4 or 8
+
+        // A larger factor whose latency a lower oversampling is padded up to,
+        // so switching between the two keeps the timing; 0 for none
+        int latencyOversampling = 0;
+
+        static float normalisedFrequency(double hz)
+        {
+            return static_cast<float>(std::clamp(std::log(hz / 20.0) / std::log(1000.0), 0.0, 1.0));
+        }
+    };
+
+    class Core
+    {
+    public:
+        // Level below which input counts as silence and filter state as fully
+        // decayed (about -180 dBFS); also the end of the reported tail
+        static constexpr double silenceThreshold = 1.0e-9;
+
+        // The filter state must sit this far below silenceThreshold before a
+        // block may sleep: low, resonant settings briefly amplify what is left
+        // of the state (up to ~20x at 40 Hz), and the output has to stay under
+        // the threshold, not just the state
+        static constexpr double stateSilenceThreshold = silenceThreshold * 1.0e-3;
+
+        // Length of the crossfade when the oversampling factor or the latency
+        // changes, e.g. when the quality governor changes tier
+        static constexpr double transitionSeconds = 0.02;
+
+        // Allocates; call from prepareToPlay or its equivalent. Every dither
+        // stream is derived from seed, so equal seeds give equal output. The
+        // kernel instruction set is chosen here, see selectIsa().
+        void prepare(double newSampleRate, int newNumChannels, uint32_t seed, const Parameters& initial)
+        {
+            sampleRate = newSampleRate;
+            numChannels = newNumChannels;
+            params = initial;
+            isa = selectIsa();
+
+            for (auto& path : paths)
+            {
+                path.floatCascade.prepare(numChannels, isa);
+                path.doubleCascade.prepare(numChannels, isa);
+                path.oversampler.prepare(numChannels, isa);
+                path.pre.prepare(numChannels, maxPad);
+                path.post.prepare(numChannels, maxPad);
+            }
+
+            inputHistory.prepare(numChannels, historyLength);
+            inputHistory.setLength(historyLength);
+            historyPointers.assign(static_cast<size_t>(numChannels), nullptr);
+            for (int ch = 0; ch < numChannels; ++ch)
+                historyPointers[static_cast<size_t>(ch)] = inputHistory.getChannel(ch);
+
+            floatFade.prepare(numChannels);
+            doubleFade.prepare(numChannels);
+            floatPointers.assign(static_cast<size_t>(numChannels), nullptr);
+            doublePointers.assign(static_cast<size_t>(numChannels), nullptr);
+
+            live = 0;
+            fadeFrom = -1;
+            latency = latencyFor(params);
+            startPath(paths[live], Oversampler::validFactor(params.oversampling), latency);
+
+            // xorshift32 needs non-zero seeds; keep them in the range the
+            // original plugin drew from
+            uint32_t x = seed != 0 ? seed : 0x9e3779b9u;
+            dither.prepare(numChannels, [&x] {
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                return 16386u + x % (static_cast<uint32_t>(std::numeric_limits<int>::max()) - 16386u);
+                }, isa);
+        }
+
+        // Clears the filter memory without touching parameters or seeds
+        void reset()
+        {
+            for (auto& path : paths)
+            {
+                path.floatCascade.reset();
+                path.doubleCascade.reset();
+                path.oversampler.reset();
+                path.pre.reset();
+                path.post.reset();
+                path.asleep = false;
+            }
+
+            inputHistory.reset();
+            fadeFrom = -1;
+            paths[live].smoother.reset(params.freq, params.weight, params.strength, params.bypass);
+        }
+
+        // Freq, Weight and Strength glide to the new values and bypass
+        // crossfades; the rest apply at the next block. A precision change
+        // carries the filter state over, so it does not click, and so does
+        // a change of oversampling factor or latency, which crossfades to the
+        // new rate over transitionSeconds.
+        void setParameters(const Parameters& newParams)
+        {
+            params = newParams;
+
+            const int factor = Oversampler::validFactor(params.oversampling);
+            const int newLatency = latencyFor(params);
+
+            if (factor != paths[live].oversampler.getFactor() || newLatency != latency)
+                beginTransition(factor, newLatency);
+
+            paths[live].smoother.setTargets(params.freq, params.weight, params.strength, params.bypass);
+            if (fadeFrom >= 0)
+                paths[fadeFrom].smoother.setTargets(params.freq, params.weight, params.strength, params.bypass);
+        }
+
+        const Parameters& getParameters() const { return params; }
+
+        // True while blocks skip the cascade: bypassed, Weight 0, or silent
+        // input with fully decayed state
+        bool isSleeping() const { return fadeFrom < 0 && paths[live].asleep; }
+
+        // True while a change of oversampling or latency is crossfading
+        bool isTransitioning() const { return fadeFrom >= 0; }
+
+        // How long the output keeps ringing after the input stops, for the
+        // given settings at the prepared sample rate
+        double getTailLengthSeconds(const Parameters& p) const
+        {
+            if (p.bypass || p.weight == 0.0f)
+                return 0.0;
+
+            const double rate = sampleRate * Oversampler::validFactor(p.oversampling);
+            CoefficientCache cache;
+            cache.prepare(rate);
+            const auto k = cache.calculate(p.freq, p.weight, p.strength);
+            return tailLengthSamples(k, p.poles, silenceThreshold, rate * 30.0) / rate;
+        }
+
+        // Delay added by oversampling, in host-rate frames; 0 without it.
+        // Follows the larger of oversampling and latencyOversampling.
+        int getLatencySamples() const { return latency; }
+
+        static int latencyFor(const Parameters& p)
+        {
+            return Oversampler::latencyFor(std::max(p.oversampling, p.latencyOversampling));
+        }
+
+        double getSampleRate() const { return sampleRate; }
+        int getNumChannels() const { return numChannels; }
+
+        // Instruction set the kernels run with since the last prepare
+        Isa getIsa() const { return isa; }
+
+        // Processes numSamples of up to getNumChannels() planar channels in place
+        template<typename T>
+        void process(T* const* channels, int numChannelsToProcess, int numSamples)
+        {
+            processStrided(channels, numChannelsToProcess, numSamples, 1);
+        }
+
+        // Processes numFrames of interleaved audio in place, without copying
+        template<typename T>
+        void processInterleaved(T* data, int numChannelsInData, int numFrames)
+        {
+            auto& pointers = getPointers<T>();
+            const int count = std::min(numChannelsInData, numChannels);
+
+            for (int ch = 0; ch < count; ++ch)
+                pointers[static_cast<size_t>(ch)] = data + ch;
+
+            processStrided(pointers.data(), count, numFrames, numChannelsInData);
+        }
+
+        // Renders a whole signal with every core and the parameter targets held
+        // fixed. Allocates and starts threads, so never call it in real time.
+        template<typename T>
+        void processOffline(T* const* channels, int numChannelsToProcess, int64_t numSamples, int numThreads = 0)
+        {
+            if (params.bypass || params.weight == 0.0f)
+                return;
+
+            auto& path = paths[live];
+            numChannelsToProcess = std::min(numChannelsToProcess, numChannels);
+            setActiveStages(path, params.poles);
+
+            CoefficientCache cache;
+            cache.prepare(sampleRate * path.oversampler.getFactor());
+            auto engine = std::make_unique<StateSpaceEngine>();
+            engine->setCoefficients(cache.calculate(params.freq, params.weight, params.strength),
+                params.weight, path.activeStages);
+
+            withLiveCascade(path, [&](auto& cascade) {
+                if (path.oversampler.getFactor() > 1)
+                    renderOversampled(path, *engine, cascade, channels, numChannelsToProcess, numSamples, numThreads);
+                else
+                    renderOffline(*engine, cascade, channels, numChannelsToProcess, numSamples, numThreads);
+                });
+
+            if constexpr (std::is_same_v<T, float>)
+            {
+                for (int64_t start = 0; start < numSamples; start += std::numeric_limits<int>::max())
+                {
+                    const int length = static_cast<int>(std::min<int64_t>(std::numeric_limits<int>::max(), numSamples - start));
+
+                    for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                        floatPointers[static_cast<size_t>(ch)] = channels[ch] + start;
+
+                    WeightAlphaDither::process(dither, params.dither, floatPointers.data(), numChannelsToProcess, length);
+                }
+            }
+        }
+
+    private:
+        // Everything that runs at one processing rate: the resamplers, the
+        // glides, the filter state in both storage types (only the one the
+        // precision policy uses is live) and the delays before and after the
+        // filter that pad the path's latency up to the reported one
+        struct Path
+        {
+            ControlRateSmoother smoother;
+            StateSpaceEngine stateSpace;
+            Oversampler oversampler;
+            FrameDelay pre, post;
+            CascadeState<float> floatCascade;
+            CascadeState<double> doubleCascade;
+            bool doubleStateLive = true;
+            int activeStages = defaultStages;
+            bool asleep = false;
+        };
+
+        // The new path's buffers while a transition runs: a copy of the input
+        // to process, and the old path's output in place
+        template<typename T>
+        struct FadeBuffers
+        {
+            std::vector<T> samples;
+            std::vector<T*> incoming, outgoing;
+
+            void prepare(int channels)
+            {
+                samples.assign(static_cast<size_t>(channels * Oversampler::maxChunk), T(0));
+                incoming.assign(static_cast<size_t>(channels), nullptr);
+                outgoing.assign(static_cast<size_t>(channels), nullptr);
+
+                for (int ch = 0; ch < channels; ++ch)
+                    incoming[static_cast<size_t>(ch)] = samples.data() + ch * Oversampler::maxChunk;
+            }
+        };
+
+        // Longest pad before or after the filter: half the largest latency
+        static constexpr int maxPad = Oversampler::latencyFor(Oversampler::maxFactor) / 2;
+
+        // Input frames kept for priming a new path; covers the memory of the
+        // longest chain of upsampling filters plus the largest pad
+        static constexpr int historyLength = 64;
+
+        // Sets a path up from scratch for a factor, padded to newLatency. The
+        // latencies are even, and an up- and downsampling round trip delays
+        // by half its latency each way, so splitting the pad evenly keeps the
+        // filter at the same point in time for any factor. Does not allocate.
+        void startPath(Path& path, int factor, int newLatency)
+        {
+            path.oversampler.setFactor(factor);
+            path.smoother.prepare(sampleRate * factor);
+            path.smoother.reset(params.freq, params.weight, params.strength, params.bypass);
+
+            const int pad = newLatency - Oversampler::latencyFor(factor);
+            path.pre.setLength(pad / 2);
+            path.post.setLength(pad - pad / 2);
+
+            path.floatCascade.reset();
+            path.doubleCascade.reset();
+            path.doubleStateLive = usesDoubleState(params.precision);
+            path.activeStages = std::clamp(params.poles, 1, maxStages);
+            path.asleep = false;
+        }
+
+        // Moves processing to a new factor or latency without a click. The
+        // other path takes over the filter state, with its resamplers and
+        // pre-delay primed from the recent input, runs unheard until its own
+        // output is valid and is then crossfaded in. Does not allocate.
+        void beginTransition(int factor, int newLatency)
+        {
+            // Mid-fade, the path heard most carries on
+            if (fadeFrom >= 0 && fadeGain(0) < 0.5)
+                live = fadeFrom;
+
+            const Path& from = paths[live];
+            Path& to = paths[1 - live];
+            const int fromFactor = from.oversampler.getFactor();
+
+            startPath(to, factor, newLatency);
+            to.smoother.follow(from.smoother);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                to.pre.load(ch, inputHistory.getChannel(ch), historyLength);
+
+            if (factor > 1)
+                to.oversampler.upsample(historyPointers.data(), numChannels, 0, historyLength - to.pre.getLength(), 1,
+                    to.oversampler.getBuffers());
+
+            // The state at another rate: per-sample slopes scale with the
+            // sample period, and each level moves along its slope from the old
+            // path's last sample to the new one's, which lie a fraction of a
+            // host frame apart
+            const double slopeScale = static_cast<double>(fromFactor) / factor;
+            const double levelShift = 1.0 - slopeScale;
+            to.doubleStateLive = from.doubleStateLive;
+            to.activeStages = from.activeStages;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                double s[2 * maxStages];
+
+                if (from.doubleStateLive)
+                    from.doubleCascade.readChannel(ch, maxStages, s);
+                else
+                    from.floatCascade.readChannel(ch, maxStages, s);
+
+                for (int i = 0; i < maxStages; ++i)
+                {
+                    s[2 * i] += s[2 * i + 1] * levelShift;
+                    s[2 * i + 1] *= slopeScale;
+                }
+
+                if (to.doubleStateLive)
+                    to.doubleCascade.writeChannel(ch, maxStages, s);
+                else
+                    to.floatCascade.writeChannel(ch, maxStages, s);
+            }
+
+            fadeFrom = live;
+            live = 1 - live;
+            fadePosition = 0;
+            fadeWait = newLatency / 2; // until the new path's output side has filled
+            fadeLength = std::max(1, static_cast<int>(std::lround(sampleRate * transitionSeconds)));
+            latency = newLatency;
+        }
+
+        // The new path's share of the output offset frames into the next block
+        double fadeGain(int offset) const
+        {
+            return std::clamp(static_cast<double>(fadePosition + offset - fadeWait) / fadeLength, 0.0, 1.0);
+        }
+
+        template<typename T>
+        std::vector<T*>& getPointers()
+        {
+            if constexpr (std::is_same_v<T, float>)
+                return floatPointers;
+            else
+                return doublePointers;
+        }
+
+        template<typename T>
+        FadeBuffers<T>& getFadeBuffers()
+        {
+            if constexpr (std::is_same_v<T, float>)
+                return floatFade;
+            else
+                return doubleFade;
+        }
+
+        // Calls fn with the cascade state the precision policy computes in,
+        // first moving the state over if the policy changed storage type
+        template<typename Fn>
+        void withLiveCascade(Path& path, Fn&& fn)
+        {
+            const bool wantDouble = usesDoubleState(params.precision);
+
+            if (wantDouble != path.doubleStateLive)
+            {
+                if (wantDouble)
+                    copyState(path.floatCascade, path.doubleCascade);
+                else
+                    copyState(path.doubleCascade, path.floatCascade);
+
+                path.doubleStateLive = wantDouble;
+            }
+
+            if (path.doubleStateLive)
+                fn(path.doubleCascade);
+            else
+                fn(path.floatCascade);
+        }
+
+        template<typename From, typename To>
+        void copyState(const CascadeState<From>& from, CascadeState<To>& to)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                double s[2 * maxStages];
+                from.readChannel(ch, maxStages, s);
+                to.writeChannel(ch, maxStages, s);
+            }
+        }
+
+        // Stages switched back on start from silence rather than stale state
+        static void setActiveStages(Path& path, int numStages)
+        {
+            numStages = std::clamp(numStages, 1, maxStages);
+            if (numStages > path.activeStages)
+            {
+                path.floatCascade.clearStages(path.activeStages, numStages);
+                path.doubleCascade.clearStages(path.activeStages, numStages);
+            }
+            path.activeStages = numStages;
+        }
+
+        template<typename T>
+        static bool isSilent(T* const* channels, int numChannelsToCheck, int numSamples, int stride)
+        {
+            for (int ch = 0; ch < numChannelsToCheck; ++ch)
+                for (int n = 0; n < numSamples; ++n)
+                    if (!(std::abs(channels[ch][n * stride]) <= static_cast<T>(silenceThreshold)))
+                        return false;
+
+            return true;
+        }
+
+        template<typename T>
+        void processStrided(T* const* channels, int numChannelsToProcess, int numSamples, int stride)
+        {
+            numChannelsToProcess = std::min(numChannelsToProcess, numChannels);
+            inputHistory.write(channels, numChannelsToProcess, numSamples, stride);
+
+            const bool processed = fadeFrom >= 0 ? processFading(channels, numChannelsToProcess, numSamples, stride)
+                                                 : processPath(paths[live], channels, numChannelsToProcess, numSamples, stride);
+
+            // The noise floor only matters when the result is truncated to 32-bit float
+            if constexpr (std::is_same_v<T, float>)
+            {
+                if (processed)
+                    WeightAlphaDither::process(dither, params.dither, channels, numChannelsToProcess, numSamples, stride);
+            }
+        }
+
+        template<typename T>
+        bool processPath(Path& path, T* const* channels, int numChannelsToProcess, int numSamples, int stride)
+        {
+            bool processed = false;
+
+            withLiveCascade(path, [&](auto& cascade) {
+                processed = processCascadeState(path, cascade, channels, numChannelsToProcess, numSamples, stride);
+                });
+
+            return processed;
+        }
+
+        // Runs both paths during a transition, the new one on a copy of the
+        // input, and mixes them; the old one stops once the fade is over
+        template<typename T>
+        bool processFading(T* const* channels, int numChannelsToProcess, int numSamples, int stride)
+        {
+            auto& fade = getFadeBuffers<T>();
+            bool processed = false;
+
+            for (int start = 0; start < numSamples; start += Oversampler::maxChunk)
+            {
+                const int length = std::min(Oversampler::maxChunk, numSamples - start);
+
+                for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                {
+                    const auto c = static_cast<size_t>(ch);
+                    fade.outgoing[c] = channels[ch] + start * stride;
+                    for (int n = 0; n < length; ++n)
+                        fade.incoming[c][n] = fade.outgoing[c][n * stride];
+                }
+
+                processed |= processPath(paths[fadeFrom], fade.outgoing.data(), numChannelsToProcess, length, stride);
+                processed |= processPath(paths[live], fade.incoming.data(), numChannelsToProcess, length, 1);
+
+                for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                {
+                    const auto c = static_cast<size_t>(ch);
+                    for (int n = 0; n < length; ++n)
+                    {
+                        T& out = fade.outgoing[c][n * stride];
+                        const double x = static_cast<double>(out);
+                        out = static_cast<T>(x + fadeGain(n) * (static_cast<double>(fade.incoming[c][n]) - x));
+                    }
+                }
+
+                fadePosition += length;
+
+                if (fadePosition >= fadeWait + fadeLength)
+                {
+                    fadeFrom = -1;
+                    const int next = start + length;
+
+                    if (next < numSamples)
+                    {
+                        for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                            fade.outgoing[static_cast<size_t>(ch)] = channels[ch] + next * stride;
+
+                        processed |= processPath(paths[live], fade.outgoing.data(), numChannelsToProcess, numSamples - next, stride);
+                    }
+
+                    break;
+                }
+            }
+
+            return processed;
+        }
+
+        // Runs the block on buffers of T with state (and arithmetic) of S,
+        // at the path's rate and through its delays. Returns false if the
+        // block was skipped and left untouched.
+        template<typename S, typename T>
+        bool processCascadeState(Path& path, CascadeState<S>& cascade, T* const* channels, int numChannelsToProcess,
+            int numSamples, int stride)
+        {
+            const int factor = path.oversampler.getFactor();
+            const bool padded = path.pre.getLength() + path.post.getLength() > 0;
+            const bool dry = path.smoother.isFullyDry();
+
+            // Once bypass or Weight 0 has faded out the cascade is not run. The
+            // state is dropped so switching back on starts clean, not from
+            // stale values, and fades in from there.
+            if (dry && !path.asleep)
+                cascade.reset();
+
+            // Without oversampling or padding a dry block needs nothing at
+            // all; with either the signal still has to go through the delay
+            if (dry && factor == 1 && !padded)
+            {
+                path.asleep = true;
+                return false;
+            }
+
+            setActiveStages(path, params.poles);
+
+            // Silence in and nothing left ringing: the output would be the
+            // silent input again, so leave it untouched (dither included)
+            if (isSilent(channels, numChannelsToProcess, numSamples, stride)
+                && cascade.isBelow(path.activeStages, static_cast<S>(stateSilenceThreshold))
+                && path.oversampler.isBelow(stateSilenceThreshold)
+                && path.pre.isBelow(stateSilenceThreshold) && path.post.isBelow(stateSilenceThreshold))
+            {
+                if (!path.asleep)
+                {
+                    cascade.reset();
+                    path.oversampler.reset();
+                    path.pre.reset();
+                    path.post.reset();
+                }
+
+                path.asleep = true;
+                path.smoother.skip(numSamples * factor);
+                return false;
+            }
+
+            path.asleep = dry;
+            path.pre.process(channels, numChannelsToProcess, numSamples, stride);
+
+            if (factor == 1)
+            {
+                if (!dry)
+                    processSmoothed(path, cascade, channels, numChannelsToProcess, numSamples, stride);
+            }
+            else
+            {
+                for (int start = 0; start < numSamples; start += Oversampler::maxChunk)
+                {
+                    const int length = std::min(Oversampler::maxChunk, numSamples - start);
+                    auto* buffers = path.oversampler.getBuffers();
+
+                    path.oversampler.upsample(channels, numChannelsToProcess, start, length, stride, buffers);
+
+                    if (!dry)
+                        processSmoothed(path, cascade, buffers, numChannelsToProcess, length * factor, 1);
+
+                    path.oversampler.downsample(buffers, channels, numChannelsToProcess, start, length, stride);
+                }
+            }
+
+            path.post.process(channels, numChannelsToProcess, numSamples, stride);
+            return true;
+        }
+
+        // The smoothed cascade over numSamples at the processing rate
+        template<typename S, typename T>
+        void processSmoothed(Path& path, CascadeState<S>& cascade, T* const* channels, int numChannelsToProcess,
+            int numSamples, int stride)
+        {
+            const bool floatIO = params.precision == Precision::doubleStateFloatIO;
+
+            path.smoother.process(numSamples, [&](int start, int length, const ControlRamp& ramp) {
+                // The block engine needs fixed coefficients, so ramps always take the recursive kernel
+                if (params.stateSpace && ramp.isConstant())
+                {
+                    path.stateSpace.setCoefficients(ramp.from, ramp.weightFrom, path.activeStages);
+                    path.stateSpace.process(cascade, channels, numChannelsToProcess, start, length, stride);
+                }
+                else
+                {
+                    processCascade(cascade, channels, numChannelsToProcess, start, length, ramp, path.activeStages, stride, floatIO);
+                }
+                });
+        }
+
+        // Offline render at the oversampled rate, a segment at a time so that
+        // memory stays bounded. The resamplers' delay is taken out: the input
+        // runs on into getLatencySamples() frames of silence and as many
+        // frames are dropped from the front, so the result lines up with it.
+        template<typename S, typename T>
+        void renderOversampled(const Path& path, const StateSpaceEngine& engine, CascadeState<S>& cascade, T* const* channels,
+            int numChannelsToProcess, int64_t numSamples, int numThreads)
+        {
+            constexpr int segmentLength = Oversampler::maxChunk * 256;
+            const int factor = path.oversampler.getFactor();
+            const int64_t delay = path.oversampler.getLatencySamples();
+            const int64_t total = numSamples + delay;
+
+            Oversampler resampler;
+            resampler.prepare(numChannelsToProcess, isa);
+            resampler.setFactor(factor);
+
+            std::vector<double> input(static_cast<size_t>(numChannelsToProcess * segmentLength));
+            std::vector<double> high(static_cast<size_t>(numChannelsToProcess * segmentLength * factor));
+            std::vector<double*> inputPointers, highPointers, chunkPointers(static_cast<size_t>(numChannelsToProcess));
+
+            for (int ch = 0; ch < numChannelsToProcess; ++ch)
+            {
+                inputPointers.push_back(input.data() + ch * segmentLength);
+                highPointers.push_back(high.data() + ch * segmentLength * factor);
+            }
+
+            for (int64_t segmentStart = 0; segmentStart < total; segmentStart += segmentLength)
+            {
+                const int length = static_cast<int>(std::min<int64_t>(segmentLength, total - segmentStart));
+
+                for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                    for (int n = 0; n < length; ++n)
+                        inputPointers[static_cast<size_t>(ch)][n] = segmentStart + n < numSamples
+                            ? static_cast<double>(channels[ch][segmentStart + n]) : 0.0;
+
+                for (int start = 0; start < length; start += Oversampler::maxChunk)
+                {
+                    for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                        chunkPointers[static_cast<size_t>(ch)] = highPointers[static_cast<size_t>(ch)] + start * factor;
+
+                    resampler.upsample(inputPointers.data(), numChannelsToProcess, start,
+                        std::min(Oversampler::maxChunk, length - start), 1, chunkPointers.data());
+                }
+
+                renderOffline(engine, cascade, highPointers.data(), numChannelsToProcess, int64_t(length) * factor, numThreads);
+
+                for (int start = 0; start < length; start += Oversampler::maxChunk)
+                {
+                    for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                        chunkPointers[static_cast<size_t>(ch)] = highPointers[static_cast<size_t>(ch)] + start * factor;
+
+                    resampler.downsample(chunkPointers.data(), inputPointers.data(), numChannelsToProcess, start,
+                        std::min(Oversampler::maxChunk, length - start), 1);
+                }
+
+                // Everything up to the end of this segment has been read, so the
+                // delayed result can go back in place
+                for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                    for (int n = 0; n < length; ++n)
+                    {
+                        const int64_t out = segmentStart + n - delay;
+                        if (out >= 0)
+                            channels[ch][out] = static_cast<T>(inputPointers[static_cast<size_t>(ch)][n]);
+                    }
+            }
+        }
+
+        Parameters params;
+        double sampleRate = 44100.0;
+        int numChannels = 0;
+        Isa isa = Isa::scalar;
+        int latency = 0;
+
+        // The live path, and while a transition crossfades the one it
+        // replaces; fadeWait frames pass before the new one is heard
+        std::array<Path, 2> paths;
+        int live = 0;
+        int fadeFrom = -1;
+        int fadePosition = 0, fadeWait = 0, fadeLength = 1;
+
+        FrameDelay inputHistory;
+        std::vector<const double*> historyPointers;
+        FadeBuffers<float> floatFade;
+        FadeBuffers<double> doubleFade;
+
+        WeightAlphaDither::State dither;
+        std::vector<float*> floatPointers;
+        std::vector<double*> doublePointers;
+    };
+}
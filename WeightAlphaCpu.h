@@ -0,0 +1,179 @@
+#pragma once
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+ #define WEIGHTALPHA_X86 1
+ #include <immintrin.h>
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <cpuid.h>
+ #endif
+#else
+ #define WEIGHTALPHA_X86 0
+#endif
+
+// Run-time choice of instruction set. The SIMD kernels are compiled once per
+// instruction set in the same binary (see WeightAlphaDSPKernels.inl); the
+// best one the CPU and OS support is picked when processing is prepared, so
+// one build runs on SSE2-only machines and still uses AVX-512 where present.
+namespace WeightAlphaDSP
+{
+    // Ordered from least to most capable
+    enum class Isa
+    {
+        scalar = 0,
+        sse2,
+        avx2,
+        avx512
+    };
+
+    constexpr int numIsas = 4;
+
+    inline const char* isaName(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::sse2:   return "sse2";
+        case Isa::avx2:   return "avx2";
+        case Isa::avx512: return "avx512";
+        case Isa::scalar: break;
+        }
+        return "scalar";
+    }
+
+    // Accepts the names returned by isaName; false for anything else
+    inline bool parseIsa(const char* name, Isa& isa)
+    {
+        for (int i = 0; i < numIsas; ++i)
+        {
+            if (name != nullptr && std::strcmp(name, isaName(static_cast<Isa>(i))) == 0)
+            {
+                isa = static_cast<Isa>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    namespace detail
+    {
+#if WEIGHTALPHA_X86
+        inline void cpuid(int leaf, int subleaf, unsigned int (&regs)[4])
+        {
+ #if defined(_MSC_VER)
+            int r[4];
+            __cpuidex(r, leaf, subleaf);
+            for (int i = 0; i < 4; ++i)
+                regs[i] = static_cast<unsigned int>(r[i]);
+ #else
+            regs[0] = regs[1] = regs[2] = regs[3] = 0;
+            __get_cpuid_count(static_cast<unsigned int>(leaf), static_cast<unsigned int>(subleaf),
+                &regs[0], &regs[1], &regs[2], &regs[3]);
+ #endif
+        }
+
+        // Register state the OS saves on context switches (XCR0)
+        inline unsigned long long enabledRegisterState()
+        {
+ #if defined(_MSC_VER)
+            return _xgetbv(0);
+ #else
+            unsigned int lo, hi;
+            __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+            return (static_cast<unsigned long long>(hi) << 32) | lo;
+ #endif
+        }
+
+        inline Isa queryCpu()
+        {
+            unsigned int regs[4];
+            cpuid(0, 0, regs);
+            const unsigned int maxLeaf = regs[0];
+
+            cpuid(1, 0, regs);
+            const bool sse2 = (regs[3] & (1u << 26)) != 0;
+            const bool osxsave = (regs[2] & (1u << 27)) != 0;
+            const bool avx = (regs[2] & (1u << 28)) != 0;
+
+            if (!sse2)
+                return Isa::scalar;
+
+            // AVX registers are only usable when the OS saves them
+            if (!(osxsave && avx) || maxLeaf < 7)
+                return Isa::sse2;
+
+            const auto xcr0 = enabledRegisterState();
+            if ((xcr0 & 0x6) != 0x6)
+                return Isa::sse2;
+
+            cpuid(7, 0, regs);
+            const bool avx2 = (regs[1] & (1u << 5)) != 0;
+            const bool avx512f = (regs[1] & (1u << 16)) != 0;
+
+            if (avx512f && avx2 && (xcr0 & 0xe6) == 0xe6)
+                return Isa::avx512;
+
+            return avx2 ? Isa::avx2 : Isa::sse2;
+        }
+#else
+        inline Isa queryCpu() { return Isa::scalar; }
+#endif
+
+        // -1 while no override is set
+        inline std::atomic<int> isaOverride{ -1 };
+    }
+
+    // Most capable instruction set this machine can run; cached after the
+    // first call
+    inline Isa detectIsa()
+    {
+        static const Isa detected = detail::queryCpu();
+        return detected;
+    }
+
+    // Forces a kernel variant for testing and benchmarking, process-wide. It
+    // takes effect at the next prepare; a variant the CPU cannot run falls
+    // back to detectIsa(). The WEIGHTALPHA_ISA environment variable
+    // (scalar, sse2, avx2, avx512) does the same without code changes.
+    inline void setIsaOverride(Isa isa) { detail::isaOverride.store(static_cast<int>(isa)); }
+    inline void clearIsaOverride() { detail::isaOverride.store(-1); }
+
+    // The variant prepare() uses: the override if one is set and supported,
+    // otherwise the best detected one
+    inline Isa selectIsa()
+    {
+        const Isa best = detectIsa();
+        Isa requested = best;
+        const int forced = detail::isaOverride.load();
+
+        if (forced >= 0)
+            requested = static_cast<Isa>(forced);
+        else if (!parseIsa(std::getenv("WEIGHTALPHA_ISA"), requested))
+            requested = best;
+
+        return static_cast<int>(requested) <= static_cast<int>(best) ? requested : best;
+    }
+}
+
+// Pragmas that compile the code between BEGIN and END for one instruction set,
+// whatever the compiler's global target. MSVC emits any intrinsic without
+// them, so there they expand to nothing. GCC would otherwise fuse multiplies
+// and adds wherever the target has FMA, and every variant must produce the
+// same bits.
+#define WEIGHTALPHA_PRAGMA(x) _Pragma(#x)
+
+#if defined(__clang__)
+ #define WEIGHTALPHA_TARGET_BEGIN(features) \
+    WEIGHTALPHA_PRAGMA(clang attribute push(__attribute__((target(features))), apply_to = function))
+ #define WEIGHTALPHA_TARGET_END _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+ #define WEIGHTALPHA_TARGET_BEGIN(features) \
+    _Pragma("GCC push_options") WEIGHTALPHA_PRAGMA(GCC target(features)) _Pragma("GCC optimize(\"fp-contract=off\")")
+ #define WEIGHTALPHA_TARGET_END _Pragma("GCC pop_options")
+#else
+ #define WEIGHTALPHA_TARGET_BEGIN(features)
+ #define WEIGHTALPHA_TARGET_END
+#endif
@@ -0,0 +1,309 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "WeightAlphaCoefficients.h"
+#include "WeightAlphaCpu.h"
+
+// Airwindows Weight cascade with audio channels packed into SIMD lanes, so a
+// group of channels is updated by the same instructions. The kernels are
+// built for every instruction set in WeightAlphaCpu.h and the state records
+// which one it was prepared for. Deliberately free of JUCE so it can be
+// reused outside the plugin.
+namespace WeightAlphaDSP
+{
+    // Cascade depth is the "Poles" parameter; the original Weight uses eight
+    constexpr int maxStages = 16;
+    constexpr int defaultStages = 8;
+
+    inline int numGroupsFor(int numChannels, int width)
+    {
+        return (numChannels + width - 1) / width;
+    }
+
+    // Lanes per register of the cascade kernels for an instruction set
+    template<typename T>
+    constexpr int packWidth(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::avx512: return 64 / static_cast<int>(sizeof(T));
+        case Isa::avx2:   return 32 / static_cast<int>(sizeof(T));
+        case Isa::sse2:   return 16 / static_cast<int>(sizeof(T));
+        case Isa::scalar: break;
+        }
+        return 2;
+    }
+
+    // Per-stage prev/trend for every channel group, stored group-major so the
+    // stages of one group sit next to each other in memory. Each value is one
+    // cache line, enough for the widest register; narrower variants use the
+    // front of it. Room is always kept for maxStages so the pole count can
+    // change without allocating.
+    template<typename T>
+    struct CascadeState
+    {
+        static constexpr int maxWidth = 64 / static_cast<int>(sizeof(T));
+
+        struct alignas(64) Line
+        {
+            T v[maxWidth];
+        };
+
+        std::vector<Line> prev, trend;
+        int numChannels = 0;
+        Isa isa = Isa::scalar;
+        int width = packWidth<T>(Isa::scalar);
+
+        // Allocates; call from prepareToPlay, never from the audio thread.
+        // The layout follows the instruction set the kernels will run with.
+        void prepare(int channels, Isa kernelIsa = selectIsa())
+        {
+            numChannels = channels;
+            isa = kernelIsa;
+            width = packWidth<T>(isa);
+            const auto size = static_cast<size_t>(numGroupsFor(channels, width) * maxStages);
+            prev.assign(size, Line{});
+            trend.assign(size, Line{});
+        }
+
+        void reset()
+        {
+            std::fill(prev.begin(), prev.end(), Line{});
+            std::fill(trend.begin(), trend.end(), Line{});
+        }
+
+        // Copies one channel's first numStages stages out of the packed layout
+        // as { prev0, trend0, prev1, trend1, ... }
+        void readChannel(int channel, int numStages, double* out) const
+        {
+            const int group = channel / width, lane = channel % width;
+
+            for (int i = 0; i < numStages; ++i)
+            {
+                const auto index = static_cast<size_t>(group * maxStages + i);
+                out[2 * i] = prev[index].v[lane];
+                out[2 * i + 1] = trend[index].v[lane];
+            }
+        }
+
+        void writeChannel(int channel, int numStages, const double* in)
+        {
+            const int group = channel / width, lane = channel % width;
+
+            for (int i = 0; i < numStages; ++i)
+            {
+                const auto index = static_cast<size_t>(group * maxStages + i);
+                prev[index].v[lane] = static_cast<T>(in[2 * i]);
+                trend[index].v[lane] = static_cast<T>(in[2 * i + 1]);
+            }
+        }
+
+        // True when every prev/trend value of the first numStages stages lies
+        // within +-threshold, i.e. nothing audible is left ringing
+        bool isBelow(int numStages, T threshold) const
+        {
+            for (size_t base = 0; base < prev.size(); base += maxStages)
+            {
+                for (int i = 0; i < numStages; ++i)
+                {
+                    for (const auto* lines : { &prev, &trend })
+                    {
+                        const auto& line = (*lines)[base + static_cast<size_t>(i)];
+                        for (int k = 0; k < width; ++k)
+                            if (!(std::abs(line.v[k]) <= threshold))
+                                return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        // Zeroes stages [firstStage, lastStage) of every group
+        void clearStages(int firstStage, int lastStage)
+        {
+            for (size_t base = 0; base < prev.size(); base += maxStages)
+            {
+                for (int i = firstStage; i < lastStage; ++i)
+                {
+                    prev[base + static_cast<size_t>(i)] = Line{};
+                    trend[base + static_cast<size_t>(i)] = Line{};
+                }
+            }
+        }
+    };
+
+    // Coefficients and wet level at the start and end of a run of samples;
+    // the kernel interpolates linearly between them, one step per sample.
+    struct ControlRamp
+    {
+        Coefficients from, to;
+        float weightFrom = 0.0f, weightTo = 0.0f;
+
+        static ControlRamp constant(const Coefficients& c, float weight) { return { c, c, weight, weight }; }
+
+        bool isConstant() const
+        {
+            return from.alpha == to.alpha && from.beta == to.beta && weightFrom == weightTo;
+        }
+    };
+
+    // Internal arithmetic of the cascade, chosen independently of the type of
+    // the buffers it processes:
+    //   pureFloat           float state and arithmetic: widest SIMD, least accurate
+    //                       at low Freq and many poles
+    //   doubleStateFloatIO  double state and arithmetic, samples rounded to float
+    //                       on the way in and out
+    //   pureDouble          double throughout
+    enum class Precision
+    {
+        pureFloat = 0,
+        doubleStateFloatIO,
+        pureDouble
+    };
+
+    constexpr int numPrecisions = 3;
+
+    inline bool usesDoubleState(Precision precision) { return precision != Precision::pureFloat; }
+
+    inline const char* precisionName(Precision precision)
+    {
+        switch (precision)
+        {
+        case Precision::pureFloat:          return "float";
+        case Precision::doubleStateFloatIO: return "double-state";
+        case Precision::pureDouble:         break;
+        }
+        return "double";
+    }
+
+    // Accepts the names returned by precisionName; false for anything else
+    inline bool parsePrecision(const char* name, Precision& precision)
+    {
+        for (int i = 0; i < numPrecisions; ++i)
+        {
+            if (name != nullptr && std::strcmp(name, precisionName(static_cast<Precision>(i))) == 0)
+            {
+                precision = static_cast<Precision>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // T is the buffer sample type, S the state and arithmetic type
+    template<typename T, typename S>
+    using CascadeKernel = void (*)(CascadeState<S>&, T* const*, int, int, int, const ControlRamp&, int);
+
+    // One copy of the kernels per instruction set
+    namespace isa_scalar
+    {
+#define WEIGHTALPHA_KERNEL_ISA 0
+#include "WeightAlphaDSPKernels.inl"
+#undef WEIGHTALPHA_KERNEL_ISA
+    }
+
+#if WEIGHTALPHA_X86
+WEIGHTALPHA_TARGET_BEGIN("sse2")
+    namespace isa_sse2
+    {
+#define WEIGHTALPHA_KERNEL_ISA 1
+#include "WeightAlphaDSPKernels.inl"
+#undef WEIGHTALPHA_KERNEL_ISA
+    }
+WEIGHTALPHA_TARGET_END
+
+WEIGHTALPHA_TARGET_BEGIN("avx2")
+    namespace isa_avx2
+    {
+#define WEIGHTALPHA_KERNEL_ISA 2
+#include "WeightAlphaDSPKernels.inl"
+#undef WEIGHTALPHA_KERNEL_ISA
+    }
+WEIGHTALPHA_TARGET_END
+
+WEIGHTALPHA_TARGET_BEGIN("avx512f")
+    namespace isa_avx512
+    {
+#define WEIGHTALPHA_KERNEL_ISA 3
+#include "WeightAlphaDSPKernels.inl"
+#undef WEIGHTALPHA_KERNEL_ISA
+    }
+WEIGHTALPHA_TARGET_END
+#endif
+
+    namespace detail
+    {
+        template<typename T, typename S, bool floatIO>
+        inline CascadeKernel<T, S> selectCascadeKernel(Isa isa, size_t stageIndex, size_t laneIndex)
+        {
+            switch (isa)
+            {
+#if WEIGHTALPHA_X86
+            case Isa::avx512: return isa_avx512::kernelTable<T, S, floatIO>()[stageIndex][laneIndex];
+            case Isa::avx2:   return isa_avx2::kernelTable<T, S, floatIO>()[stageIndex][laneIndex];
+            case Isa::sse2:   return isa_sse2::kernelTable<T, S, floatIO>()[stageIndex][laneIndex];
+#endif
+            default:          return isa_scalar::kernelTable<T, S, floatIO>()[stageIndex][laneIndex];
+            }
+        }
+    }
+
+    using HalfBandKernel = void (*)(const double*, int, double, const double*, double*, int);
+
+    // The half-band resampler branch for an instruction set, see Oversampler
+    inline HalfBandKernel selectHalfBandKernel(Isa isa)
+    {
+        switch (isa)
+        {
+#if WEIGHTALPHA_X86
+        case Isa::avx512: return &isa_avx512::processHalfBandBranch;
+        case Isa::avx2:   return &isa_avx2::processHalfBandBranch;
+        case Isa::sse2:   return &isa_sse2::processHalfBandBranch;
+#endif
+        default:          return &isa_scalar::processHalfBandBranch;
+        }
+    }
+
+    // Picks the pre-instantiated kernel for an instruction set, stage count
+    // and channel count; look it up once per block and reuse it for every
+    // sub-block. floatIO rounds samples through float at the kernel's edges,
+    // which only changes anything for double buffers with double state.
+    template<typename T, typename S>
+    inline CascadeKernel<T, S> selectCascadeKernel(Isa isa, int numStages, int numChannels, bool floatIO = false)
+    {
+        const auto stageIndex = static_cast<size_t>(std::clamp(numStages, 1, maxStages) - 1);
+        const size_t laneIndex = numChannels == 1 ? 0 : (numChannels == 2 ? 1 : 2);
+
+        if constexpr (std::is_same_v<T, double> && std::is_same_v<S, double>)
+        {
+            if (floatIO)
+                return detail::selectCascadeKernel<T, S, true>(isa, stageIndex, laneIndex);
+        }
+
+        return detail::selectCascadeKernel<T, S, false>(isa, stageIndex, laneIndex);
+    }
+
+    // Runs the cascade and the wet/dry mix in place on samples
+    // [startSample, startSample + numSamples) of up to st.numChannels
+    // channels, computing in the state's type S. Lanes past the last channel of a group carry silence.
+    // Sample n of a channel is channels[ch][n * stride], so interleaved audio
+    // is processed where it lies by passing pointers to each channel's first
+    // sample and the frame size as the stride.
+    template<typename S, typename T>
+    inline void processCascade(CascadeState<S>& st, T* const* channels, int numChannels,
+        int startSample, int numSamples, const ControlRamp& control, int numStages = defaultStages, int stride = 1,
+        bool floatIO = false)
+    {
+        numChannels = std::min(numChannels, st.numChannels);
+
+        if (numSamples > 0 && numChannels > 0)
+            selectCascadeKernel<T, S>(st.isa, numStages, numChannels, floatIO)(st, channels, numChannels, startSample, numSamples, control, stride);
+    }
+}
@@ -0,0 +1,335 @@
+// Cascade and resampler kernels for one instruction set. WeightAlphaDSP.h includes this
+// file once per variant, inside that variant's namespace and target pragmas,
+// with WEIGHTALPHA_KERNEL_ISA set to the matching Isa value. No include
+// guard, and nothing here may include other headers.
+
+// One register of channels, lane k holding channel (group * width + k)
+template<typename T>
+struct Pack;
+
+#if WEIGHTALPHA_KERNEL_ISA == 3
+template<>
+struct Pack<double>
+{
+    static constexpr int width = 8;
+    __m512d v;
+
+    static Pack load(const double* p) { return { _mm512_load_pd(p) }; }
+    void store(double* p) const { _mm512_store_pd(p, v); }
+    static Pack loadUnaligned(const double* p) { return { _mm512_loadu_pd(p) }; }
+    void storeUnaligned(double* p) const { _mm512_storeu_pd(p, v); }
+    static Pack broadcast(double x) { return { _mm512_set1_pd(x) }; }
+    static Pack zero() { return { _mm512_setzero_pd() }; }
+
+    Pack operator+(Pack b) const { return { _mm512_add_pd(v, b.v) }; }
+    Pack operator-(Pack b) const { return { _mm512_sub_pd(v, b.v) }; }
+    Pack operator*(Pack b) const { return { _mm512_mul_pd(v, b.v) }; }
+};
+
+template<>
+struct Pack<float>
+{
+    static constexpr int width = 16;
+    __m512 v;
+
+    static Pack load(const float* p) { return { _mm512_load_ps(p) }; }
+    void store(float* p) const { _mm512_store_ps(p, v); }
+    static Pack loadUnaligned(const float* p) { return { _mm512_loadu_ps(p) }; }
+    void storeUnaligned(float* p) const { _mm512_storeu_ps(p, v); }
+    static Pack broadcast(float x) { return { _mm512_set1_ps(x) }; }
+    static Pack zero() { return { _mm512_setzero_ps() }; }
+
+    Pack operator+(Pack b) const { return { _mm512_add_ps(v, b.v) }; }
+    Pack operator-(Pack b) const { return { _mm512_sub_ps(v, b.v) }; }
+    Pack operator*(Pack b) const { return { _mm512_mul_ps(v, b.v) }; }
+};
+#elif WEIGHTALPHA_KERNEL_ISA == 2
+template<>
+struct Pack<double>
+{
+    static constexpr int width = 4;
+    __m256d v;
+
+    static Pack load(const double* p) { return { _mm256_load_pd(p) }; }
+    void store(double* p) const { _mm256_store_pd(p, v); }
+    static Pack loadUnaligned(const double* p) { return { _mm256_loadu_pd(p) }; }
+    void storeUnaligned(double* p) const { _mm256_storeu_pd(p, v); }
+    static Pack broadcast(double x) { return { _mm256_set1_pd(x) }; }
+    static Pack zero() { return { _mm256_setzero_pd() }; }
+
+    Pack operator+(Pack b) const { return { _mm256_add_pd(v, b.v) }; }
+    Pack operator-(Pack b) const { return { _mm256_sub_pd(v, b.v) }; }
+    Pack operator*(Pack b) const { return { _mm256_mul_pd(v, b.v) }; }
+};
+
+template<>
+struct Pack<float>
+{
+    static constexpr int width = 8;
+    __m256 v;
+
+    static Pack load(const float* p) { return { _mm256_load_ps(p) }; }
+    void store(float* p) const { _mm256_store_ps(p, v); }
+    static Pack loadUnaligned(const float* p) { return { _mm256_loadu_ps(p) }; }
+    void storeUnaligned(float* p) const { _mm256_storeu_ps(p, v); }
+    static Pack broadcast(float x) { return { _mm256_set1_ps(x) }; }
+    static Pack zero() { return { _mm256_setzero_ps() }; }
+
+    Pack operator+(Pack b) const { return { _mm256_add_ps(v, b.v) }; }
+    Pack operator-(Pack b) const { return { _mm256_sub_ps(v, b.v) }; }
+    Pack operator*(Pack b) const { return { _mm256_mul_ps(v, b.v) }; }
+};
+#elif WEIGHTALPHA_KERNEL_ISA == 1
+template<>
+struct Pack<double>
+{
+    static constexpr int width = 2;
+    __m128d v;
+
+    static Pack load(const double* p) { return { _mm_load_pd(p) }; }
+    void store(double* p) const { _mm_store_pd(p, v); }
+    static Pack loadUnaligned(const double* p) { return { _mm_loadu_pd(p) }; }
+    void storeUnaligned(double* p) const { _mm_storeu_pd(p, v); }
+    static Pack broadcast(double x) { return { _mm_set1_pd(x) }; }
+    static Pack zero() { return { _mm_setzero_pd() }; }
+
+    Pack operator+(Pack b) const { return { _mm_add_pd(v, b.v) }; }
+    Pack operator-(Pack b) const { return { _mm_sub_pd(v, b.v) }; }
+    Pack operator*(Pack b) const { return { _mm_mul_pd(v, b.v) }; }
+};
+
+template<>
+struct Pack<float>
+{
+    static constexpr int width = 4;
+    __m128 v;
+
+    static Pack load(const float* p) { return { _mm_load_ps(p) }; }
+    void store(float* p) const { _mm_store_ps(p, v); }
+    static Pack loadUnaligned(const float* p) { return { _mm_loadu_ps(p) }; }
+    void storeUnaligned(float* p) const { _mm_storeu_ps(p, v); }
+    static Pack broadcast(float x) { return { _mm_set1_ps(x) }; }
+    static Pack zero() { return { _mm_setzero_ps() }; }
+
+    Pack operator+(Pack b) const { return { _mm_add_ps(v, b.v) }; }
+    Pack operator-(Pack b) const { return { _mm_sub_ps(v, b.v) }; }
+    Pack operator*(Pack b) const { return { _mm_mul_ps(v, b.v) }; }
+};
+#else
+// Portable variant: two lanes of plain scalars
+template<typename T>
+struct Pack
+{
+    static constexpr int width = 2;
+    T v[width];
+
+    static Pack load(const T* p) { return { { p[0], p[1] } }; }
+    void store(T* p) const { p[0] = v[0]; p[1] = v[1]; }
+    static Pack loadUnaligned(const T* p) { return load(p); }
+    void storeUnaligned(T* p) const { store(p); }
+    static Pack broadcast(T x) { return { { x, x } }; }
+    static Pack zero() { return { { T(0), T(0) } }; }
+
+    Pack operator+(Pack b) const { return { { v[0] + b.v[0], v[1] + b.v[1] } }; }
+    Pack operator-(Pack b) const { return { { v[0] - b.v[0], v[1] - b.v[1] } }; }
+    Pack operator*(Pack b) const { return { { v[0] * b.v[0], v[1] * b.v[1] } }; }
+};
+
+// A mono stream needs one lane, so the portable mono kernel does half the work
+template<typename T>
+struct SinglePack
+{
+    static constexpr int width = 1;
+    T v;
+
+    static SinglePack load(const T* p) { return { p[0] }; }
+    void store(T* p) const { p[0] = v; }
+    static SinglePack loadUnaligned(const T* p) { return load(p); }
+    void storeUnaligned(T* p) const { store(p); }
+    static SinglePack broadcast(T x) { return { x }; }
+    static SinglePack zero() { return { T(0) }; }
+
+    SinglePack operator+(SinglePack b) const { return { v + b.v }; }
+    SinglePack operator-(SinglePack b) const { return { v - b.v }; }
+    SinglePack operator*(SinglePack b) const { return { v * b.v }; }
+};
+#endif
+
+// The register type a kernel for a fixed lane count works in. Lane 0 holds
+// channel 0 either way, so mono and stereo kernels share one state layout.
+#if WEIGHTALPHA_KERNEL_ISA == 0
+template<typename T, int Lanes>
+using PackFor = std::conditional_t<Lanes == 1, SinglePack<T>, Pack<T>>;
+#else
+template<typename T, int Lanes>
+using PackFor = Pack<T>;
+#endif
+
+// The only place samples change type: buffer type T to arithmetic type S
+// on the way in and back on the way out, through float when floatIO is set
+template<typename To, bool floatIO, typename From>
+inline To convertSample(From x)
+{
+    if constexpr (floatIO)
+        return static_cast<To>(static_cast<float>(x));
+    else
+        return static_cast<To>(x);
+}
+
+// Samples are read as T, computed and stored as S with S coefficients, so the
+// stage loop has no conversions. Stages and Lanes are compile-time so the
+// stage loop unrolls and the common mono/stereo cases skip the group loop.
+// Lanes == 0 handles any channel count at run time.
+template<typename T, typename S, bool floatIO, int Stages, int Lanes, bool ramp>
+inline void processCascade(CascadeState<S>& st, T* const* channels, int numChannels,
+    int startSample, int numSamples, const ControlRamp& control, int stride)
+{
+    using P = PackFor<S, Lanes>;
+    constexpr int width = P::width;
+    static_assert(Lanes <= width, "fixed lane count must fit one register");
+    static_assert(width <= CascadeState<S>::maxWidth, "state lines must hold one register");
+
+    const double inv = ramp ? 1.0 / numSamples : 0.0;
+    const auto da = P::broadcast(static_cast<S>((control.to.alpha - control.from.alpha) * inv));
+    const auto db = P::broadcast(static_cast<S>((control.to.beta - control.from.beta) * inv));
+    const auto dw = P::broadcast(static_cast<S>((control.weightTo - control.weightFrom) * inv));
+
+    for (int group = 0; group * width < numChannels; ++group)
+    {
+        T* const* groupChannels = channels + group * width;
+        const int lanes = Lanes > 0 ? Lanes : std::min(width, numChannels - group * width);
+        auto* prevLines = st.prev.data() + group * maxStages;
+        auto* trendLines = st.trend.data() + group * maxStages;
+        alignas(64) S lane[width] = {};
+
+        // Held in locals for the whole run so the stages stay in registers
+        P prev[Stages], trend[Stages];
+        for (int i = 0; i < Stages; ++i)
+        {
+            prev[i] = P::load(prevLines[i].v);
+            trend[i] = P::load(trendLines[i].v);
+        }
+
+        // With a ramp the first sample already takes one step, so the last
+        // sample lands exactly on the end values
+        auto a = P::broadcast(static_cast<S>(control.from.alpha));
+        auto oneMinusA = P::broadcast(static_cast<S>(0.999 - control.from.alpha));
+        auto b = P::broadcast(static_cast<S>(control.from.beta));
+        auto oneMinusB = P::broadcast(static_cast<S>(0.999 - control.from.beta));
+        auto wet = P::broadcast(static_cast<S>(control.weightFrom));
+        auto dry = P::broadcast(static_cast<S>(1.0f - control.weightFrom));
+
+        for (int n = startSample; n < startSample + numSamples; ++n)
+        {
+            if constexpr (ramp)
+            {
+                a = a + da; oneMinusA = oneMinusA - da;
+                b = b + db; oneMinusB = oneMinusB - db;
+                wet = wet + dw; dry = dry - dw;
+            }
+
+            if constexpr (Lanes > 0)
+            {
+                for (int k = 0; k < Lanes; ++k)
+                    lane[k] = convertSample<S, floatIO>(groupChannels[k][n * stride]);
+            }
+            else
+            {
+                for (int k = 0; k < lanes; ++k)
+                    lane[k] = convertSample<S, floatIO>(groupChannels[k][n * stride]);
+            }
+
+            const auto in = P::load(lane);
+            auto x = in;
+
+            for (int i = 0; i < Stages; ++i)
+            {
+                const auto newTrend = b * (x - prev[i]) + oneMinusB * trend[i];
+                const auto forecast = prev[i] + trend[i];
+                x = a * x + oneMinusA * forecast;
+                prev[i] = x;
+                trend[i] = newTrend;
+            }
+
+            x = x * wet + in * dry;
+            x.store(lane);
+
+            if constexpr (Lanes > 0)
+            {
+                for (int k = 0; k < Lanes; ++k)
+                    groupChannels[k][n * stride] = convertSample<T, floatIO>(lane[k]);
+            }
+            else
+            {
+                for (int k = 0; k < lanes; ++k)
+                    groupChannels[k][n * stride] = convertSample<T, floatIO>(lane[k]);
+            }
+        }
+
+        for (int i = 0; i < Stages; ++i)
+        {
+            prev[i].store(prevLines[i].v);
+            trend[i].store(trendLines[i].v);
+        }
+
+        if constexpr (Lanes > 0)
+            break;
+    }
+}
+
+template<typename T, typename S, bool floatIO, int Stages, int Lanes>
+void processCascadeKernel(CascadeState<S>& st, T* const* channels, int numChannels,
+    int startSample, int numSamples, const ControlRamp& control, int stride)
+{
+    if (control.isConstant())
+        processCascade<T, S, floatIO, Stages, Lanes, false>(st, channels, numChannels, startSample, numSamples, control, stride);
+    else
+        processCascade<T, S, floatIO, Stages, Lanes, true>(st, channels, numChannels, startSample, numSamples, control, stride);
+}
+
+template<typename T, typename S, bool floatIO, size_t... StageIndex>
+constexpr auto makeKernelTable(std::index_sequence<StageIndex...>)
+{
+    return std::array<std::array<CascadeKernel<T, S>, 3>, sizeof...(StageIndex)> { {
+        { { &processCascadeKernel<T, S, floatIO, static_cast<int>(StageIndex) + 1, 1>,
+            &processCascadeKernel<T, S, floatIO, static_cast<int>(StageIndex) + 1, 2>,
+            &processCascadeKernel<T, S, floatIO, static_cast<int>(StageIndex) + 1, 0> } }...
+    } };
+}
+
+// [stages - 1][mono, stereo, any]
+template<typename T, typename S, bool floatIO>
+const std::array<std::array<CascadeKernel<T, S>, 3>, maxStages>& kernelTable()
+{
+    static constexpr auto table = makeKernelTable<T, S, floatIO>(std::make_index_sequence<maxStages>{});
+    return table;
+}
+
+// out[i] = sum of gain * taps[m] * (in[i + m] + in[i + numTaps - 1 - m]) over
+// the first numTaps / 2 taps: one polyphase branch of the half-band
+// resampler. A register of outputs takes every tap before moving on, adding
+// in the same order as the scalar tail, so each variant gives the same bits.
+inline void processHalfBandBranch(const double* taps, int numTaps, double gain, const double* in, double* out,
+    int numSamples)
+{
+    using P = Pack<double>;
+    constexpr int width = P::width;
+    const int half = numTaps / 2;
+    const int vectorEnd = numSamples - numSamples % width;
+
+    for (int i = 0; i < vectorEnd; i += width)
+    {
+        auto sum = P::zero();
+        for (int m = 0; m < half; ++m)
+            sum = sum + P::broadcast(taps[m] * gain) * (P::loadUnaligned(in + i + m) + P::loadUnaligned(in + i + numTaps - 1 - m));
+        sum.storeUnaligned(out + i);
+    }
+
+    for (int i = vectorEnd; i < numSamples; ++i)
+    {
+        double sum = 0.0;
+        for (int m = 0; m < half; ++m)
+            sum += taps[m] * gain * (in[i + m] + in[i + numTaps - 1 - m]);
+        out[i] = sum;
+    }
+}
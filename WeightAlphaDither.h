@@ -0,0 +1,144 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "WeightAlphaCpu.h"
+
+// Noise-floor stage for the 32-bit float output. The Airwindows mode matches
+// the statistics of the original frexpf/pow code but builds the 2^exponent
+// scale straight from the float's bits, and runs several xorshift32 streams
+// side by side so the whole block is generated with vectorisable loops.
+namespace WeightAlphaDither
+{
+    enum class Mode
+    {
+        off = 0,
+        airwindows,
+        tpdf
+    };
+
+    // Number of interleaved generator streams per channel; sample n of a
+    // group of eight uses stream n % lanes.
+    constexpr int lanes = 8;
+
+    struct State
+    {
+        std::vector<uint32_t> seeds; // numChannels * lanes
+        int numChannels = 0;
+        WeightAlphaDSP::Isa isa = WeightAlphaDSP::Isa::scalar;
+
+        // Allocates; call from prepareToPlay, never from the audio thread.
+        // nextSeed is called once per stream and must return a non-zero value.
+        template<typename SeedSource>
+        void prepare(int channels, SeedSource&& nextSeed, WeightAlphaDSP::Isa kernelIsa = WeightAlphaDSP::selectIsa())
+        {
+            numChannels = channels;
+            isa = kernelIsa;
+            seeds.resize(static_cast<size_t>(channels * lanes));
+            for (auto& seed : seeds)
+                seed = static_cast<uint32_t>(nextSeed());
+        }
+    };
+
+    namespace detail
+    {
+        inline void step(uint32_t (&s)[lanes])
+        {
+            for (int k = 0; k < lanes; ++k)
+            {
+                s[k] ^= s[k] << 13;
+                s[k] ^= s[k] >> 17;
+                s[k] ^= s[k] << 5;
+            }
+        }
+
+        // 2^e where e is the frexp exponent of x, built from the bits of x.
+        // Zero gives e == 0 like frexpf(0). A denormal's 2^e is the power of
+        // two just above its mantissa, a denormal itself (or the smallest
+        // normal), found by smearing the mantissa's top bit downwards.
+        // Infinities, NaNs and the largest binade are held to 2^127.
+        inline float exponentScale(float x)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            const int32_t biased = static_cast<int32_t>((bits >> 23) & 0xffu);
+            uint32_t mantissa = bits & 0x7fffffu;
+            mantissa |= mantissa >> 1;
+            mantissa |= mantissa >> 2;
+            mantissa |= mantissa >> 4;
+            mantissa |= mantissa >> 8;
+            mantissa |= mantissa >> 16;
+            const uint32_t denormalBits = mantissa == 0 ? 127u << 23 : mantissa + 1;
+            const uint32_t scaleBits = biased == 0 ? denormalBits : static_cast<uint32_t>(std::min(biased + 1, 254)) << 23;
+            float scale;
+            std::memcpy(&scale, &scaleBits, sizeof(scale));
+            return scale;
+        }
+    }
+
+    // One copy of the per-channel loop per instruction set, so the compiler
+    // vectorises it for each target
+    namespace isa_scalar
+    {
+#include "WeightAlphaDitherKernels.inl"
+    }
+
+#if WEIGHTALPHA_X86
+WEIGHTALPHA_TARGET_BEGIN("sse2")
+    namespace isa_sse2
+    {
+#include "WeightAlphaDitherKernels.inl"
+    }
+WEIGHTALPHA_TARGET_END
+
+WEIGHTALPHA_TARGET_BEGIN("avx2")
+    namespace isa_avx2
+    {
+#include "WeightAlphaDitherKernels.inl"
+    }
+WEIGHTALPHA_TARGET_END
+
+WEIGHTALPHA_TARGET_BEGIN("avx512f")
+    namespace isa_avx512
+    {
+#include "WeightAlphaDitherKernels.inl"
+    }
+WEIGHTALPHA_TARGET_END
+#endif
+
+    namespace detail
+    {
+        using ChannelKernel = void (*)(float*, int, int, uint32_t*);
+
+        template<Mode mode>
+        inline ChannelKernel selectChannelKernel(WeightAlphaDSP::Isa isa)
+        {
+            switch (isa)
+            {
+#if WEIGHTALPHA_X86
+            case WeightAlphaDSP::Isa::avx512: return &isa_avx512::processChannel<mode>;
+            case WeightAlphaDSP::Isa::avx2:   return &isa_avx2::processChannel<mode>;
+            case WeightAlphaDSP::Isa::sse2:   return &isa_sse2::processChannel<mode>;
+#endif
+            default:                          return &isa_scalar::processChannel<mode>;
+            }
+        }
+    }
+
+    // Adds the selected noise floor in place to up to st.numChannels channels;
+    // sample n of a channel is channels[ch][n * stride]
+    inline void process(State& st, Mode mode, float* const* channels, int numChannels, int numSamples, int stride = 1)
+    {
+        numChannels = std::min(numChannels, st.numChannels);
+
+        if (mode == Mode::off)
+            return;
+
+        const auto kernel = mode == Mode::airwindows ? detail::selectChannelKernel<Mode::airwindows>(st.isa)
+                                                     : detail::selectChannelKernel<Mode::tpdf>(st.isa);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            kernel(channels[ch], numSamples, stride, st.seeds.data() + ch * lanes);
+    }
+}
@@ -0,0 +1,44 @@
+// Per-channel dither loop for one instruction set. WeightAlphaDither.h
+// includes this file once per variant, inside that variant's namespace and
+// target pragmas. No include guard, and nothing here may include other headers.
+
+template<Mode mode>
+inline void processChannel(float* data, int numSamples, int stride, uint32_t* channelSeeds)
+{
+    // 5.5e-36 * 2^62 folds the original long double constants into one factor
+    constexpr float airwindowsScale = 2.5364273e-17f;
+    // Two uniform draws of +-2^31 each, summed to a +-1 LSB triangle at 24 bits
+    constexpr float tpdfScale = 1.0f / 72057594037927936.0f; // 2^-56
+
+    alignas(32) uint32_t s[lanes];
+    std::copy(channelSeeds, channelSeeds + lanes, s);
+
+    for (int n = 0; n < numSamples; n += lanes)
+    {
+        const int count = std::min(lanes, numSamples - n);
+        alignas(32) float noise[lanes];
+
+        detail::step(s);
+
+        if constexpr (mode == Mode::airwindows)
+        {
+            for (int k = 0; k < lanes; ++k)
+                noise[k] = static_cast<float>(static_cast<int32_t>(s[k])) * airwindowsScale;
+        }
+        else
+        {
+            for (int k = 0; k < lanes; ++k)
+                noise[k] = static_cast<float>(static_cast<int32_t>(s[k]));
+
+            detail::step(s);
+
+            for (int k = 0; k < lanes; ++k)
+                noise[k] = (noise[k] + static_cast<float>(static_cast<int32_t>(s[k]))) * tpdfScale;
+        }
+
+        for (int k = 0; k < count; ++k)
+            data[(n + k) * stride] += noise[k] * detail::exponentScale(data[(n + k) * stride]);
+    }
+
+    std::copy(s, s + lanes, channelSeeds);
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include "WeightAlphaCore.h"
+
+// Adaptive quality for real-time playback. Every block's wall-clock processing
+// time is measured against the time the block represents; when the smoothed
+// load stays high the governor steps quality down one tier, and when it stays
+// low for much longer it steps back up. A step up that is undone soon after
+// doubles the wait before the next one, so a session near a threshold settles
+// instead of flapping. Deliberately free of JUCE so it can be reused outside
+// the plugin.
+namespace WeightAlphaDSP
+{
+    // Ordered from most to least expensive:
+    //   full     the parameters as set
+    //   reduced  no oversampling, at the same latency
+    //   economy  also float arithmetic (widest SIMD), at most four poles and
+    //            no dither
+    enum class QualityTier
+    {
+        full = 0,
+        reduced,
+        economy
+    };
+
+    constexpr int numQualityTiers = 3;
+
+    inline const char* qualityTierName(QualityTier tier)
+    {
+        switch (tier)
+        {
+        case QualityTier::reduced: return "reduced";
+        case QualityTier::economy: return "economy";
+        case QualityTier::full:    break;
+        }
+        return "full";
+    }
+
+    struct GovernorSettings
+    {
+        double stepDownLoad = 0.5;     // share of the block's duration
+        double stepUpLoad = 0.2;
+        double stepDownSeconds = 0.25; // how long the load must stay past a threshold
+        double stepUpSeconds = 3.0;
+        double smoothingSeconds = 0.1;
+        double warmUpSeconds = 0.5;    // ignored after prepare: cold caches, page faults
+    };
+
+    class QualityGovernor
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        void prepare(double newSampleRate, const GovernorSettings& newSettings = {})
+        {
+            sampleRate = newSampleRate;
+            settings = newSettings;
+            reset();
+        }
+
+        // Back to full quality with no history; cheap enough for the audio thread
+        void reset()
+        {
+            smoothedLoad = 0.0;
+            elapsed = 0.0;
+            sinceStepUp = std::numeric_limits<double>::infinity();
+            highFor = lowFor = 0.0;
+            stepUpScale = 1.0;
+            tier.store(static_cast<int>(QualityTier::full), std::memory_order_relaxed);
+            load.store(0.0f, std::memory_order_relaxed);
+        }
+
+        // Feeds one block: the time processing it took against the numSamples
+        // it covered. Call from the audio thread after every block.
+        void update(Clock::time_point start, Clock::time_point end, int numSamples)
+        {
+            update(std::chrono::duration<double>(end - start).count(), numSamples);
+        }
+
+        void update(double processingSeconds, int numSamples)
+        {
+            if (numSamples <= 0 || !(sampleRate > 0.0))
+                return;
+
+            const double blockSeconds = numSamples / sampleRate;
+            elapsed += blockSeconds;
+            sinceStepUp += blockSeconds;
+
+            if (elapsed < settings.warmUpSeconds)
+                return;
+
+            // One-pole average over audio time, so it does not depend on the block size
+            const double blockLoad = processingSeconds / blockSeconds;
+            const double a = std::min(1.0, blockSeconds / settings.smoothingSeconds);
+            smoothedLoad += a * (blockLoad - smoothedLoad);
+            load.store(static_cast<float>(smoothedLoad), std::memory_order_relaxed);
+
+            highFor = smoothedLoad > settings.stepDownLoad ? highFor + blockSeconds : 0.0;
+            lowFor = smoothedLoad < settings.stepUpLoad ? lowFor + blockSeconds : 0.0;
+
+            const int current = tier.load(std::memory_order_relaxed);
+
+            if (highFor >= settings.stepDownSeconds && current + 1 < numQualityTiers)
+            {
+                if (sinceStepUp < settings.stepUpSeconds * stepUpScale)
+                    stepUpScale = std::min(stepUpScale * 2.0, maxStepUpScale);
+
+                setTier(current + 1);
+            }
+            else if (lowFor >= settings.stepUpSeconds * stepUpScale && current > 0)
+            {
+                sinceStepUp = 0.0;
+                setTier(current - 1);
+            }
+        }
+
+        // Safe to read from any thread
+        QualityTier getTier() const { return static_cast<QualityTier>(tier.load(std::memory_order_relaxed)); }
+
+        // Smoothed processing time as a share of real time, 0 during warm-up
+        float getLoad() const { return load.load(std::memory_order_relaxed); }
+
+        // The parameters to process with at a tier
+        static Parameters apply(Parameters p, QualityTier qualityTier)
+        {
+            if (qualityTier == QualityTier::full)
+                return p;
+
+            // Padded to the chosen factor's latency, so the host's delay
+            // compensation holds across tiers
+            p.latencyOversampling = std::max(p.latencyOversampling, p.oversampling);
+            p.oversampling = 1;
+
+            if (qualityTier == QualityTier::economy)
+            {
+                p.precision = Precision::pureFloat;
+                p.poles = std::min(p.poles, economyPoles);
+                p.dither = WeightAlphaDither::Mode::off;
+            }
+
+            return p;
+        }
+
+    private:
+        static constexpr int economyPoles = 4;
+        static constexpr double maxStepUpScale = 16.0;
+
+        void setTier(int newTier)
+        {
+            tier.store(newTier, std::memory_order_relaxed);
+            highFor = lowFor = 0.0;
+        }
+
+        GovernorSettings settings;
+        double sampleRate = 0.0;
+        double smoothedLoad = 0.0, elapsed = 0.0, sinceStepUp = 0.0;
+        double highFor = 0.0, lowFor = 0.0;
+        double stepUpScale = 1.0;
+        std::atomic<int> tier{ static_cast<int>(QualityTier::full) };
+        std::atomic<float> load{ 0.0f };
+    };
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Per-block processing time as a share of the block's deadline, collected
+// into a fixed histogram. The audio thread is the only writer and touches
+// nothing but a few relaxed atomics; any other thread can take snapshots and
+// turn the difference between two of them into current, average and p99
+// load over that window. Deliberately free of JUCE so it can be reused
+// outside the plugin.
+namespace WeightAlphaDSP
+{
+    struct LoadStats
+    {
+        double current = 0.0; // the most recent block
+        double average = 0.0;
+        double p99 = 0.0;     // upper edge of the bin holding the 99th percentile
+        uint64_t numBlocks = 0;
+    };
+
+    class LoadHistogram
+    {
+    public:
+        // 0.5% of the deadline per bin up to 200%; slower blocks share the last one
+        static constexpr int numBins = 400;
+        static constexpr double binWidth = 0.005;
+
+        struct Snapshot
+        {
+            std::array<uint64_t, numBins> counts{};
+            uint64_t numBlocks = 0;
+            uint64_t loadSum = 0; // in units of sumScale
+        };
+
+        // Audio thread only. load is processing time over block duration.
+        void record(double load)
+        {
+            load = std::max(load, 0.0);
+            const int bin = std::min(static_cast<int>(load / binWidth), numBins - 1);
+
+            // Single writer, so plain load/store pairs instead of read-modify-writes
+            auto& count = counts[static_cast<size_t>(bin)];
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            loadSum.store(loadSum.load(std::memory_order_relaxed) + static_cast<uint64_t>(load * sumScale + 0.5),
+                std::memory_order_relaxed);
+            current.store(static_cast<float>(load), std::memory_order_relaxed);
+
+            // Published last: a reader that sees this count sees the bins behind it
+            numBlocks.store(numBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Any thread. Fills a snapshot without allocating.
+        void read(Snapshot& s) const
+        {
+            s.numBlocks = numBlocks.load(std::memory_order_acquire);
+            s.loadSum = loadSum.load(std::memory_order_relaxed);
+
+            for (size_t i = 0; i < counts.size(); ++i)
+                s.counts[i] = counts[i].load(std::memory_order_relaxed);
+        }
+
+        float getCurrent() const { return current.load(std::memory_order_relaxed); }
+
+        // Statistics of the blocks recorded between two snapshots, older first.
+        // A block being written while a snapshot was taken may be counted in
+        // the bins but not the total, or the other way round; the percentile
+        // is clamped so that never shows.
+        LoadStats statsBetween(const Snapshot& older, const Snapshot& newer) const
+        {
+            LoadStats stats;
+            stats.current = getCurrent();
+            stats.numBlocks = newer.numBlocks - older.numBlocks;
+
+            if (stats.numBlocks == 0)
+                return stats;
+
+            stats.average = static_cast<double>(newer.loadSum - older.loadSum) / sumScale / static_cast<double>(stats.numBlocks);
+
+            const uint64_t target = (stats.numBlocks * 99 + 99) / 100;
+            uint64_t seen = 0;
+
+            for (int i = 0; i < numBins; ++i)
+            {
+                const auto index = static_cast<size_t>(i);
+                seen += newer.counts[index] - std::min(older.counts[index], newer.counts[index]);
+
+                if (seen >= target || i == numBins - 1)
+                {
+                    stats.p99 = (i + 1) * binWidth;
+                    break;
+                }
+            }
+
+            return stats;
+        }
+
+    private:
+        static constexpr double sumScale = 1.0e6;
+
+        std::array<std::atomic<uint64_t>, numBins> counts{};
+        std::atomic<uint64_t> numBlocks{ 0 };
+        std::atomic<uint64_t> loadSum{ 0 };
+        std::atomic<float> current{ 0.0f };
+    };
+}
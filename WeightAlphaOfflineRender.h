@@ -0,0 +1,167 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+#include "WeightAlphaStateSpace.h"
+
+// Multi-core offline rendering of the cascade. Between the input and the
+// dither stage the filter is linear, so a long file can be cut into chunks:
+//   1. every chunk is run in parallel from a zero state to find its own
+//      contribution z to the state at its end,
+//   2. the true chunk boundary states are carried forward serially,
+//      S[c + 1] = A^L S[c] + z[c], using one precomputed A^L,
+//   3. every chunk is rendered in parallel from its exact start state.
+// The result matches a serial render to within floating-point rounding.
+// Coefficients must be fixed for the whole render; dither, if wanted, is
+// applied by the caller afterwards.
+namespace WeightAlphaDSP
+{
+    namespace detail
+    {
+        // Column-major square matrix of the engine's order
+        struct TransitionMatrix
+        {
+            int order = 0;
+            std::vector<double> m;
+
+            static TransitionMatrix identity(int order)
+            {
+                TransitionMatrix t{ order, std::vector<double>(static_cast<size_t>(order * order), 0.0) };
+                for (int i = 0; i < order; ++i)
+                    t.m[static_cast<size_t>(i * order + i)] = 1.0;
+                return t;
+            }
+
+            TransitionMatrix operator*(const TransitionMatrix& other) const
+            {
+                TransitionMatrix result{ order, std::vector<double>(m.size(), 0.0) };
+
+                for (int j = 0; j < order; ++j)
+                    for (int k = 0; k < order; ++k)
+                    {
+                        const double b = other.m[static_cast<size_t>(j * order + k)];
+                        for (int i = 0; i < order; ++i)
+                            result.m[static_cast<size_t>(j * order + i)] += m[static_cast<size_t>(k * order + i)] * b;
+                    }
+
+                return result;
+            }
+
+            void apply(const double* in, double* out) const
+            {
+                std::fill(out, out + order, 0.0);
+                for (int j = 0; j < order; ++j)
+                    for (int i = 0; i < order; ++i)
+                        out[i] += m[static_cast<size_t>(j * order + i)] * in[j];
+            }
+        };
+
+        // A^(blockLength * numBlocks) by repeated squaring of the engine's A^blockLength
+        inline TransitionMatrix transitionFor(const StateSpaceEngine& engine, int64_t numBlocks)
+        {
+            const int order = engine.getOrder();
+            TransitionMatrix base{ order, std::vector<double>(static_cast<size_t>(order * order)) };
+            const double* blockTransition = engine.getBlockTransition();
+
+            for (int j = 0; j < order; ++j)
+                for (int i = 0; i < order; ++i)
+                    base.m[static_cast<size_t>(j * order + i)] = blockTransition[j * StateSpaceEngine::maxOrder + i];
+
+            auto result = TransitionMatrix::identity(order);
+
+            for (; numBlocks > 0; numBlocks >>= 1)
+            {
+                if (numBlocks & 1)
+                    result = result * base;
+                base = base * base;
+            }
+
+            return result;
+        }
+
+        template<typename Fn>
+        void parallelFor(int count, int numThreads, Fn&& fn)
+        {
+            std::vector<std::thread> workers;
+            workers.reserve(static_cast<size_t>(numThreads));
+
+            for (int t = 0; t < numThreads; ++t)
+                workers.emplace_back([&fn, t, count, numThreads] {
+                    for (int i = t; i < count; i += numThreads)
+                        fn(i);
+                });
+
+            for (auto& w : workers)
+                w.join();
+        }
+    }
+
+    // Renders numSamples of every channel in place, continuing from and then
+    // updating st. The engine must already hold the render's coefficients.
+    // numThreads <= 0 uses every hardware thread.
+    template<typename S, typename T>
+    void renderOffline(const StateSpaceEngine& engine, CascadeState<S>& st,
+        T* const* channels, int numChannels, int64_t numSamples, int numThreads = 0)
+    {
+        constexpr int order = StateSpaceEngine::maxOrder;
+        constexpr int64_t minChunk = int64_t(StateSpaceEngine::blockLength) * 1024;
+
+        // The engine counts frames in int, so renders past 2^31 frames take
+        // more chunks rather than longer ones
+        constexpr int64_t maxChunk = std::numeric_limits<int>::max() / StateSpaceEngine::blockLength * int64_t(StateSpaceEngine::blockLength);
+
+        if (numThreads <= 0)
+            numThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+        numChannels = std::min(numChannels, st.numChannels);
+        const int64_t block = StateSpaceEngine::blockLength;
+        int64_t chunkLength = (numSamples + numThreads - 1) / numThreads;
+        chunkLength = std::min(maxChunk, std::max(minChunk, (chunkLength + block - 1) / block * block));
+        const int numChunks = static_cast<int>(std::max<int64_t>(1, (numSamples + chunkLength - 1) / chunkLength));
+        numThreads = std::min(numThreads, numChunks);
+
+        auto chunkSize = [&](int c) { return static_cast<int>(std::min(chunkLength, numSamples - int64_t(c) * chunkLength)); };
+
+        // Per channel and chunk: zero-state end contribution, then true start state
+        std::vector<double> carry(static_cast<size_t>(numChannels * numChunks * order), 0.0);
+        auto stateFor = [&](int ch, int c) { return carry.data() + static_cast<size_t>((ch * numChunks + c) * order); };
+
+        detail::parallelFor(numChunks - 1, numThreads, [&](int c) {
+            for (int ch = 0; ch < numChannels; ++ch)
+                engine.advanceState(stateFor(ch, c + 1), channels[ch] + int64_t(c) * chunkLength, chunkSize(c));
+        });
+
+        const auto transition = detail::transitionFor(engine, chunkLength / block);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            st.readChannel(ch, engine.getNumStages(), stateFor(ch, 0));
+
+            for (int c = 1; c < numChunks; ++c)
+            {
+                double propagated[order];
+                transition.apply(stateFor(ch, c - 1), propagated);
+                double* s = stateFor(ch, c);
+                for (int i = 0; i < engine.getOrder(); ++i)
+                    s[i] += propagated[i];
+            }
+        }
+
+        detail::parallelFor(numChunks, numThreads, [&](int c) {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                double s[order];
+                std::copy(stateFor(ch, c), stateFor(ch, c) + order, s);
+                engine.processChannel(s, channels[ch] + int64_t(c) * chunkLength, chunkSize(c));
+
+                if (c == numChunks - 1)
+                    std::copy(s, s + order, stateFor(ch, c));
+            }
+        });
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            st.writeChannel(ch, engine.getNumStages(), stateFor(ch, numChunks - 1));
+    }
+}
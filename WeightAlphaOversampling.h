@@ -0,0 +1,412 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+#include "WeightAlphaDSP.h"
+
+// Polyphase half-band resampling, so the cascade can run at 2x, 4x or 8x the
+// host rate where its top end no longer warps. Every 2x step is a linear-phase
+// half-band FIR split into its two phases: one is a plain delay, the other a
+// short symmetric filter, so a step costs K multiply-adds per output pair.
+// The filters are evaluated a chunk at a time by the per-ISA kernels in
+// WeightAlphaDSPKernels.inl, a register of outputs across every tap, without
+// reordering any sum. Deliberately free of JUCE so it can be reused outside
+// the plugin.
+namespace WeightAlphaDSP
+{
+    namespace detail
+    {
+        // Modified Bessel function of the first kind, order 0, for the Kaiser window
+        inline double besselI0(double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 50 && term > sum * 1.0e-17; ++k)
+            {
+                const double t = x / (2.0 * k);
+                term *= t * t;
+                sum += term;
+            }
+            return sum;
+        }
+
+        // The 2K non-zero odd taps of a Kaiser-windowed half-band lowpass of
+        // length 4K + 1, outermost first, scaled so they sum to 0.5; the centre
+        // tap is the other 0.5 and every other even tap is zero
+        inline std::vector<double> designHalfBand(int halfLength, double beta)
+        {
+            constexpr double pi = 3.14159265358979323846;
+            std::vector<double> taps(static_cast<size_t>(2 * halfLength));
+            double sum = 0.0;
+
+            for (int m = 0; m < 2 * halfLength; ++m)
+            {
+                const int k = 2 * m - (2 * halfLength - 1);
+                const double r = static_cast<double>(k) / (2.0 * halfLength);
+                const double window = besselI0(beta * std::sqrt(1.0 - r * r)) / besselI0(beta);
+                const double t = std::sin(pi * k / 2.0) / (pi * k) * window;
+                taps[static_cast<size_t>(m)] = t;
+                sum += t;
+            }
+
+            for (auto& t : taps)
+                t *= 0.5 / sum;
+
+            return taps;
+        }
+    }
+
+    class Oversampler
+    {
+    public:
+        static constexpr int maxStages = 3;
+        static constexpr int maxFactor = 1 << maxStages;
+
+        // Host-rate frames per pass; longer blocks are split
+        static constexpr int maxChunk = 256;
+
+        // Allocates for every factor up to maxFactor, so setFactor never does.
+        // Call from prepareToPlay or its equivalent. The filter kernel's
+        // instruction set is chosen here, see selectIsa().
+        void prepare(int channels, Isa isa = selectIsa())
+        {
+            numChannels = channels;
+            branch = selectHalfBandKernel(isa);
+
+            for (int s = 0; s < maxStages; ++s)
+            {
+                auto& stage = stages[static_cast<size_t>(s)];
+                stage.taps = detail::designHalfBand(halfLengths[s], kaiserBetas[s]);
+
+                // Stage s turns maxChunk << s frames into twice as many and back
+                const int frames = maxChunk << s;
+                stage.upStride = historyLength(s) + frames;
+                stage.evenStride = halfLengths[s] + frames;
+                stage.oddStride = 2 * halfLengths[s] + frames;
+                stage.up.assign(static_cast<size_t>(channels * stage.upStride), 0.0);
+                stage.even.assign(static_cast<size_t>(channels * stage.evenStride), 0.0);
+                stage.odd.assign(static_cast<size_t>(channels * stage.oddStride), 0.0);
+            }
+
+            scratch.assign(static_cast<size_t>(maxChunk * maxFactor), 0.0);
+            work.assign(static_cast<size_t>(channels * maxChunk * maxFactor), 0.0);
+            workPointers.resize(static_cast<size_t>(channels));
+
+            for (int ch = 0; ch < channels; ++ch)
+                workPointers[static_cast<size_t>(ch)] = work.data() + ch * maxChunk * maxFactor;
+
+            setFactor(factor);
+        }
+
+        // 1, 2, 4 or 8; anything else rounds down to one of those
+        static constexpr int validFactor(int requested)
+        {
+            int f = 1;
+            while (f < maxFactor && 2 * f <= requested)
+                f *= 2;
+            return f;
+        }
+
+        // Clears the filter histories, does not allocate
+        void setFactor(int newFactor)
+        {
+            factor = validFactor(newFactor);
+            numStages = 0;
+            while ((1 << numStages) < factor)
+                ++numStages;
+
+            reset();
+        }
+
+        int getFactor() const { return factor; }
+
+        // Delay of an up- and downsampling round trip in host-rate frames:
+        // 2K samples at each step's lower rate. The tap counts are chosen so
+        // this is a whole number for every factor.
+        int getLatencySamples() const { return latencyFor(factor); }
+
+        static constexpr int latencyFor(int oversamplingFactor)
+        {
+            int latency = 0;
+            for (int s = 0; (2 << s) <= validFactor(oversamplingFactor); ++s)
+                latency += (2 * halfLengths[s]) >> s;
+            return latency;
+        }
+
+        void reset()
+        {
+            for (auto& stage : stages)
+            {
+                std::fill(stage.up.begin(), stage.up.end(), 0.0);
+                std::fill(stage.even.begin(), stage.even.end(), 0.0);
+                std::fill(stage.odd.begin(), stage.odd.end(), 0.0);
+            }
+        }
+
+        // True when nothing above threshold is left in any filter history,
+        // i.e. the delayed output has caught up with silent input. Only the
+        // histories at the front of each channel's segment carry over between
+        // passes; the chunk space after them keeps whatever the last pass
+        // left there, and is never read before being written.
+        bool isBelow(double threshold) const
+        {
+            const auto below = [threshold](const double* v, int n) {
+                for (int i = 0; i < n; ++i)
+                    if (!(std::abs(v[i]) <= threshold))
+                        return false;
+                return true;
+            };
+
+            for (int s = 0; s < numStages; ++s)
+            {
+                const auto& stage = stages[static_cast<size_t>(s)];
+                const int K = halfLengths[s];
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    if (!below(stage.up.data() + ch * stage.upStride, historyLength(s))
+                        || !below(stage.even.data() + ch * stage.evenStride, K)
+                        || !below(stage.odd.data() + ch * stage.oddStride, 2 * K))
+                        return false;
+            }
+            return true;
+        }
+
+        // Planar buffers of maxChunk * maxFactor samples per channel, for
+        // callers without their own storage at the oversampled rate
+        double* const* getBuffers() { return workPointers.data(); }
+
+        // Reads frames [startSample, startSample + numSamples) of each channel
+        // (sample n at channels[ch][n * stride]) and writes numSamples * factor
+        // samples to out[ch]. numSamples must not exceed maxChunk.
+        template<typename T>
+        void upsample(const T* const* channels, int numChannelsToProcess, int startSample, int numSamples, int stride,
+            double* const* out)
+        {
+            numChannelsToProcess = std::min(numChannelsToProcess, numChannels);
+
+            for (int ch = 0; ch < numChannelsToProcess; ++ch)
+            {
+                // Stage 0 reads the host buffer, every later stage the one before it
+                double* in = stageInput(0, ch);
+                for (int n = 0; n < numSamples; ++n)
+                    in[n] = static_cast<double>(channels[ch][(startSample + n) * stride]);
+
+                int length = numSamples;
+
+                for (int s = 0; s < numStages; ++s)
+                {
+                    double* y = s + 1 < numStages ? stageInput(s + 1, ch) : out[ch];
+                    upStage(s, ch, length, y);
+                    length *= 2;
+                }
+            }
+        }
+
+        // Reduces numSamples * factor samples of in[ch] back to numSamples
+        // frames written from startSample on, the inverse of upsample()
+        template<typename T>
+        void downsample(const double* const* in, T* const* channels, int numChannelsToProcess, int startSample,
+            int numSamples, int stride)
+        {
+            numChannelsToProcess = std::min(numChannelsToProcess, numChannels);
+
+            for (int ch = 0; ch < numChannelsToProcess; ++ch)
+            {
+                int length = numSamples * factor;
+                const double* x = in[ch];
+
+                for (int s = numStages - 1; s >= 0; --s)
+                {
+                    length /= 2;
+                    downStage(s, ch, x, length);
+                    x = scratch.data();
+
+                    if (s > 0)
+                        continue;
+
+                    for (int n = 0; n < numSamples; ++n)
+                        channels[ch][(startSample + n) * stride] = static_cast<T>(scratch[static_cast<size_t>(n)]);
+                }
+            }
+        }
+
+    private:
+        struct Stage
+        {
+            std::vector<double> taps;
+
+            // Per channel: input history then room for a chunk, for the
+            // upsampler and for the two phases of the downsampler
+            std::vector<double> up, even, odd;
+            int upStride = 0, evenStride = 0, oddStride = 0;
+        };
+
+        // Half the number of non-zero odd taps per step; the first step does
+        // the real band-limiting, later ones only remove images far from the
+        // audio band. 2K >> s must stay a whole number of host frames.
+        static constexpr int halfLengths[maxStages] = { 16, 8, 4 };
+        static constexpr double kaiserBetas[maxStages] = { 10.0, 9.0, 8.0 };
+
+        static int historyLength(int s) { return 2 * halfLengths[s] - 1; }
+
+        double* stageInput(int s, int ch)
+        {
+            auto& stage = stages[static_cast<size_t>(s)];
+            return stage.up.data() + ch * stage.upStride + historyLength(s);
+        }
+
+        // x[n] -> y[2n] = x[n - K], y[2n + 1] = twice the half-band branch
+        void upStage(int s, int ch, int numSamples, double* y)
+        {
+            auto& stage = stages[static_cast<size_t>(s)];
+            const int K = halfLengths[s];
+            const int history = historyLength(s);
+            double* x = stage.up.data() + ch * stage.upStride;
+
+            branch(stage.taps.data(), static_cast<int>(stage.taps.size()), 2.0, x, scratch.data(), numSamples);
+
+            for (int n = 0; n < numSamples; ++n)
+            {
+                y[2 * n] = x[n + K - 1];
+                y[2 * n + 1] = scratch[static_cast<size_t>(n)];
+            }
+
+            std::copy(x + numSamples, x + numSamples + history, x);
+        }
+
+        // y[n] = 0.5 * v[2n - 2K] + the half-band branch over the odd phase
+        // v[2n - 4K + 1] ... v[2n - 1]; leaves numSamples results in scratch
+        void downStage(int s, int ch, const double* v, int numSamples)
+        {
+            auto& stage = stages[static_cast<size_t>(s)];
+            const int K = halfLengths[s];
+            double* even = stage.even.data() + ch * stage.evenStride;
+            double* odd = stage.odd.data() + ch * stage.oddStride;
+
+            for (int n = 0; n < numSamples; ++n)
+            {
+                even[K + n] = v[2 * n];
+                odd[2 * K + n] = v[2 * n + 1];
+            }
+
+            branch(stage.taps.data(), static_cast<int>(stage.taps.size()), 1.0, odd, scratch.data(), numSamples);
+
+            for (int n = 0; n < numSamples; ++n)
+                scratch[static_cast<size_t>(n)] += 0.5 * even[n];
+
+            std::copy(even + numSamples, even + numSamples + K, even);
+            std::copy(odd + numSamples, odd + numSamples + 2 * K, odd);
+        }
+
+        std::array<Stage, maxStages> stages;
+        std::vector<double> scratch, work;
+        std::vector<double*> workPointers;
+        HalfBandKernel branch = selectHalfBandKernel(Isa::scalar);
+        int numChannels = 0;
+        int numStages = 0;
+        int factor = 1;
+    };
+
+    // A delay of a whole number of frames per channel, applied in place. It
+    // pads a path up to a longer latency, and with the length set to the
+    // history wanted it also keeps the last frames a stream carried.
+    class FrameDelay
+    {
+    public:
+        // Allocates; call from prepareToPlay or its equivalent
+        void prepare(int channels, int newCapacity)
+        {
+            numChannels = channels;
+            capacity = newCapacity;
+            history.assign(static_cast<size_t>(channels * capacity), 0.0);
+            carry.assign(static_cast<size_t>(capacity), 0.0);
+            length = std::min(length, capacity);
+        }
+
+        // Clears the line, does not allocate
+        void setLength(int frames)
+        {
+            length = std::clamp(frames, 0, capacity);
+            reset();
+        }
+
+        int getLength() const { return length; }
+
+        void reset() { std::fill(history.begin(), history.end(), 0.0); }
+
+        // The frames waiting in one channel's line, oldest first
+        const double* getChannel(int ch) const { return history.data() + ch * capacity; }
+
+        // Replaces one channel's waiting frames with the newest getLength()
+        // of the numFrames in recent, oldest first
+        void load(int ch, const double* recent, int numFrames)
+        {
+            double* h = history.data() + ch * capacity;
+            const int n = std::min(length, numFrames);
+            std::fill(h, h + length - n, 0.0);
+            std::copy(recent + numFrames - n, recent + numFrames, h + length - n);
+        }
+
+        // Delays numSamples frames of each channel (sample n at
+        // channels[ch][n * stride]) by getLength(), in place
+        template<typename T>
+        void process(T* const* channels, int numChannelsToProcess, int numSamples, int stride)
+        {
+            push<true>(channels, numChannelsToProcess, numSamples, stride);
+        }
+
+        // Takes in numSamples frames of each channel as process() would,
+        // leaving the buffers untouched
+        template<typename T>
+        void write(const T* const* channels, int numChannelsToProcess, int numSamples, int stride)
+        {
+            push<false>(channels, numChannelsToProcess, numSamples, stride);
+        }
+
+        bool isBelow(double threshold) const
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = 0; i < length; ++i)
+                    if (!(std::abs(getChannel(ch)[i]) <= threshold))
+                        return false;
+            return true;
+        }
+
+    private:
+        template<bool output, typename T>
+        void push(T* const* channels, int numChannelsToProcess, int numSamples, int stride)
+        {
+            if (length == 0)
+                return;
+
+            numChannelsToProcess = std::min(numChannelsToProcess, numChannels);
+
+            for (int ch = 0; ch < numChannelsToProcess; ++ch)
+            {
+                double* h = history.data() + ch * capacity;
+                T* x = channels[ch];
+
+                // The newest min(n, length) inputs, which the line keeps
+                const int kept = std::min(numSamples, length);
+                for (int i = 0; i < kept; ++i)
+                    carry[static_cast<size_t>(i)] = static_cast<double>(x[(numSamples - kept + i) * stride]);
+
+                if constexpr (output)
+                {
+                    for (int n = numSamples - 1; n >= length; --n)
+                        x[n * stride] = x[(n - length) * stride];
+                    for (int n = 0; n < kept; ++n)
+                        x[n * stride] = static_cast<T>(h[n]);
+                }
+
+                std::copy(h + kept, h + length, h);
+                std::copy(carry.begin(), carry.begin() + kept, h + length - kept);
+            }
+        }
+
+        std::vector<double> history, carry;
+        int numChannels = 0;
+        int capacity = 0;
+        int length = 0;
+    };
+}
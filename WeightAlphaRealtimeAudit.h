@@ -0,0 +1,149 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef WEIGHTALPHA_RT_AUDIT
+ #define WEIGHTALPHA_RT_AUDIT 0
+#endif
+
+#if WEIGHTALPHA_RT_AUDIT && !defined(_WIN32)
+ #include <execinfo.h>
+ #include <unistd.h>
+#endif
+
+// Real-time safety auditor for debug and test builds. Code that must not
+// block marks itself with a ScopedRealtimeContext (processBlock) or a
+// ScopedCallbackContext (parameter callbacks, which only count when they run
+// on a thread that has processed audio). With WEIGHTALPHA_RT_AUDIT=1 the hooks
+// in WeightAlphaRealtimeAuditHooks.inl report every heap allocation, lock and
+// blocking system call made inside such a context, with the context's name
+// and a backtrace, and count them so a test can fail on any. Set
+// WEIGHTALPHA_RT_AUDIT_ABORT to stop at the first one instead. Without the
+// flag every function here is empty and compiles away.
+namespace WeightAlphaRealtimeAudit
+{
+#if WEIGHTALPHA_RT_AUDIT
+    namespace detail
+    {
+        inline thread_local int depth = 0;
+        inline thread_local const char* context = nullptr;
+        inline thread_local bool audioThread = false;
+        inline thread_local bool reporting = false;
+        inline std::atomic<uint64_t> violations{ 0 };
+    }
+
+    // Called by the hooks; reports what when the calling thread is inside a
+    // real-time context. Writes straight to stderr without allocating.
+    inline void report(const char* what)
+    {
+        if (detail::depth == 0 || detail::reporting)
+            return;
+
+        detail::reporting = true;
+        detail::violations.fetch_add(1, std::memory_order_relaxed);
+
+        char line[256];
+        const int length = std::snprintf(line, sizeof line, "WeightAlpha real-time violation: %s inside %s\n",
+            what, detail::context != nullptr ? detail::context : "?");
+#if defined(_WIN32)
+        std::fwrite(line, 1, static_cast<size_t>(length > 0 ? length : 0), stderr);
+#else
+        if (length > 0)
+            (void) !::write(2, line, static_cast<size_t>(length));
+
+        void* frames[32];
+        backtrace_symbols_fd(frames, backtrace(frames, 32), 2);
+#endif
+
+        if (std::getenv("WEIGHTALPHA_RT_AUDIT_ABORT") != nullptr)
+            std::abort();
+
+        detail::reporting = false;
+    }
+
+    inline uint64_t getViolationCount() { return detail::violations.load(std::memory_order_relaxed); }
+    inline void resetViolationCount() { detail::violations.store(0, std::memory_order_relaxed); }
+
+    // Loads whatever backtrace() loads on first use, so the first report does
+    // not itself allocate. Call once at start-up in an audit build.
+    inline void prepare()
+    {
+#if !defined(_WIN32)
+        void* frames[4];
+        backtrace(frames, 4);
+#endif
+    }
+
+    // Marks the calling thread as an audio thread for the scope's lifetime
+    class ScopedRealtimeContext
+    {
+    public:
+        explicit ScopedRealtimeContext(const char* name) : previous(detail::context)
+        {
+            detail::context = name;
+            detail::audioThread = true;
+            ++detail::depth;
+        }
+
+        ~ScopedRealtimeContext()
+        {
+            --detail::depth;
+            detail::context = previous;
+        }
+
+        ScopedRealtimeContext(const ScopedRealtimeContext&) = delete;
+        ScopedRealtimeContext& operator=(const ScopedRealtimeContext&) = delete;
+
+    private:
+        const char* previous;
+    };
+
+    // For callbacks any thread may make; audited only on threads that have
+    // been inside a ScopedRealtimeContext, since the message thread may block
+    class ScopedCallbackContext
+    {
+    public:
+        explicit ScopedCallbackContext(const char* name) : active(detail::audioThread), previous(detail::context)
+        {
+            if (!active)
+                return;
+
+            detail::context = name;
+            ++detail::depth;
+        }
+
+        ~ScopedCallbackContext()
+        {
+            if (!active)
+                return;
+
+            --detail::depth;
+            detail::context = previous;
+        }
+
+        ScopedCallbackContext(const ScopedCallbackContext&) = delete;
+        ScopedCallbackContext& operator=(const ScopedCallbackContext&) = delete;
+
+    private:
+        bool active;
+        const char* previous;
+    };
+#else
+    inline void report(const char*) {}
+    inline uint64_t getViolationCount() { return 0; }
+    inline void resetViolationCount() {}
+    inline void prepare() {}
+
+    struct ScopedRealtimeContext
+    {
+        explicit ScopedRealtimeContext(const char*) {}
+    };
+
+    struct ScopedCallbackContext
+    {
+        explicit ScopedCallbackContext(const char*) {}
+    };
+#endif
+}
@@ -0,0 +1,220 @@
+// Hooks for the real-time auditor in WeightAlphaRealtimeAudit.h. Include this
+// in exactly one translation unit of an executable built with
+// WEIGHTALPHA_RT_AUDIT=1 (the conformance harness and the benchmark do): it
+// replaces the global operator new/delete and, on ELF and Mach-O systems,
+// interposes the pthread lock and blocking system-call entry points, each of
+// which reports before doing the real work. With glibc it also replaces
+// malloc, calloc, realloc, free, aligned_alloc and posix_memalign; elsewhere
+// (macOS, musl, Windows) C allocations go unreported, so the glibc build is
+// the one that vouches for them. Replacements in a shared library loaded by a
+// host would lose to the host's own symbols, so plugin builds rely on the
+// tests exercising the same code paths.
+#if WEIGHTALPHA_RT_AUDIT
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if !defined(_WIN32)
+ #include <cerrno>
+ #include <dlfcn.h>
+ #include <fcntl.h>
+ #include <poll.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <stdarg.h>
+ #include <sys/select.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+#if defined(__GLIBC__)
+// glibc's own allocator entry points, which the malloc hooks forward to
+// (dlsym may itself allocate, so RTLD_NEXT cannot be used for these)
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void* __libc_memalign(size_t, size_t);
+extern "C" void __libc_free(void*);
+#endif
+
+namespace WeightAlphaRealtimeAudit
+{
+    namespace hooks
+    {
+        inline void* allocate(std::size_t size, std::size_t alignment)
+        {
+            report(alignment > alignof(std::max_align_t) ? "aligned operator new" : "operator new");
+            size = size != 0 ? size : 1;
+#if defined(_WIN32)
+            return alignment > alignof(std::max_align_t) ? _aligned_malloc(size, alignment) : std::malloc(size);
+#elif defined(__GLIBC__)
+            // Straight to glibc, so the malloc hooks don't report it again
+            return alignment > alignof(std::max_align_t) ? __libc_memalign(alignment, size) : __libc_malloc(size);
+#else
+            void* p = nullptr;
+            if (alignment > alignof(std::max_align_t))
+                return posix_memalign(&p, alignment, size) == 0 ? p : nullptr;
+            return std::malloc(size);
+#endif
+        }
+
+        inline void release(void* p, std::size_t alignment)
+        {
+            if (p == nullptr)
+                return;
+
+            report("operator delete");
+#if defined(_WIN32)
+            if (alignment > alignof(std::max_align_t))
+            {
+                _aligned_free(p);
+                return;
+            }
+#else
+            (void) alignment;
+#endif
+#if defined(__GLIBC__)
+            __libc_free(p);
+#else
+            std::free(p);
+#endif
+        }
+
+        inline void* allocateOrThrow(std::size_t size, std::size_t alignment)
+        {
+            if (void* p = allocate(size, alignment))
+                return p;
+            throw std::bad_alloc();
+        }
+
+#if !defined(_WIN32)
+        // The next definition of a symbol after ours, looked up once without
+        // a guarded static (whose guard could take the lock being hooked)
+        template<typename Fn>
+        Fn next(std::atomic<void*>& cache, const char* name)
+        {
+            void* p = cache.load(std::memory_order_acquire);
+            if (p == nullptr)
+            {
+                p = dlsym(RTLD_NEXT, name);
+                cache.store(p, std::memory_order_release);
+            }
+            return reinterpret_cast<Fn>(p);
+        }
+#endif
+    }
+}
+
+void* operator new(std::size_t size) { return WeightAlphaRealtimeAudit::hooks::allocateOrThrow(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size) { return WeightAlphaRealtimeAudit::hooks::allocateOrThrow(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t a) { return WeightAlphaRealtimeAudit::hooks::allocateOrThrow(size, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t size, std::align_val_t a) { return WeightAlphaRealtimeAudit::hooks::allocateOrThrow(size, static_cast<std::size_t>(a)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return WeightAlphaRealtimeAudit::hooks::allocate(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return WeightAlphaRealtimeAudit::hooks::allocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept { return WeightAlphaRealtimeAudit::hooks::allocate(size, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept { return WeightAlphaRealtimeAudit::hooks::allocate(size, static_cast<std::size_t>(a)); }
+
+void operator delete(void* p) noexcept { WeightAlphaRealtimeAudit::hooks::release(p, alignof(std::max_align_t)); }
+void operator delete[](void* p) noexcept { WeightAlphaRealtimeAudit::hooks::release(p, alignof(std::max_align_t)); }
+void operator delete(void* p, std::size_t) noexcept { WeightAlphaRealtimeAudit::hooks::release(p, alignof(std::max_align_t)); }
+void operator delete[](void* p, std::size_t) noexcept { WeightAlphaRealtimeAudit::hooks::release(p, alignof(std::max_align_t)); }
+void operator delete(void* p, std::align_val_t a) noexcept { WeightAlphaRealtimeAudit::hooks::release(p, static_cast<std::size_t>(a)); }
+void operator delete[](void* p, std::align_val_t a) noexcept { WeightAlphaRealtimeAudit::hooks::release(p, static_cast<std::size_t>(a)); }
+void operator delete(void* p, std::size_t, std::align_val_t a) noexcept { WeightAlphaRealtimeAudit::hooks::release(p, static_cast<std::size_t>(a)); }
+void operator delete[](void* p, std::size_t, std::align_val_t a) noexcept { WeightAlphaRealtimeAudit::hooks::release(p, static_cast<std::size_t>(a)); }
+
+#if !defined(_WIN32)
+// Declares an interposed function: reports, then forwards to the real one
+#define WEIGHTALPHA_RT_AUDIT_INTERPOSE(ret, name, params, args)                                         \
+    extern "C" ret name params                                                                          \
+    {                                                                                                   \
+        static std::atomic<void*> real{ nullptr };                                                      \
+        WeightAlphaRealtimeAudit::report(#name);                                                        \
+        return WeightAlphaRealtimeAudit::hooks::next<ret (*) params>(real, #name) args;                 \
+    }
+
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, pthread_mutex_lock, (pthread_mutex_t* m), (m))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, pthread_rwlock_rdlock, (pthread_rwlock_t* l), (l))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, pthread_rwlock_wrlock, (pthread_rwlock_t* l), (l))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, pthread_cond_wait, (pthread_cond_t* c, pthread_mutex_t* m), (c, m))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, pthread_join, (pthread_t t, void** result), (t, result))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, sem_wait, (sem_t* s), (s))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, nanosleep, (const struct timespec* t, struct timespec* left), (t, left))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, usleep, (useconds_t us), (us))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(unsigned int, sleep, (unsigned int s), (s))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(ssize_t, read, (int fd, void* buffer, size_t n), (fd, buffer, n))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(ssize_t, write, (int fd, const void* buffer, size_t n), (fd, buffer, n))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, close, (int fd), (fd))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, fsync, (int fd), (fd))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, poll, (struct pollfd* fds, nfds_t n, int timeout), (fds, n, timeout))
+WEIGHTALPHA_RT_AUDIT_INTERPOSE(int, select, (int n, fd_set* r, fd_set* w, fd_set* e, struct timeval* t), (n, r, w, e, t))
+
+#undef WEIGHTALPHA_RT_AUDIT_INTERPOSE
+
+#if defined(__GLIBC__)
+// glibc routes its own internal allocations (strdup, fopen, ...) through
+// these too, so they catch C allocations made on our behalf
+extern "C" void* malloc(size_t size) noexcept
+{
+    WeightAlphaRealtimeAudit::report("malloc");
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) noexcept
+{
+    WeightAlphaRealtimeAudit::report("calloc");
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size) noexcept
+{
+    WeightAlphaRealtimeAudit::report("realloc");
+    return __libc_realloc(p, size);
+}
+
+extern "C" void free(void* p) noexcept
+{
+    if (p != nullptr)
+        WeightAlphaRealtimeAudit::report("free");
+    __libc_free(p);
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    WeightAlphaRealtimeAudit::report("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** result, size_t alignment, size_t size) noexcept
+{
+    WeightAlphaRealtimeAudit::report("posix_memalign");
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    void* p = __libc_memalign(alignment, size);
+    if (p == nullptr)
+        return ENOMEM;
+    *result = p;
+    return 0;
+}
+#endif
+
+// open is variadic, so it cannot go through the macro
+extern "C" int open(const char* path, int flags, ...)
+{
+    static std::atomic<void*> real{ nullptr };
+    WeightAlphaRealtimeAudit::report("open");
+
+    mode_t mode = 0;
+    if ((flags & O_CREAT) != 0)
+    {
+        va_list args;
+        va_start(args, flags);
+        mode = static_cast<mode_t>(va_arg(args, int));
+        va_end(args);
+    }
+
+    return WeightAlphaRealtimeAudit::hooks::next<int (*)(const char*, int, ...)>(real, "open")(path, flags, mode);
+}
+#endif
+#endif
@@ -0,0 +1,169 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include "WeightAlphaDSP.h"
+
+// Control-rate parameter smoothing. Parameter values glide linearly towards
+// their targets; while they move, each block is cut into fixed sub-blocks
+// and the coefficients are evaluated (table-based, no pow) only at sub-block
+// edges. The kernel interpolates between those edges sample by sample.
+namespace WeightAlphaDSP
+{
+    class LinearRamp
+    {
+    public:
+        void setRampLength(int numSamples) { rampLength = numSamples; }
+
+        void setTarget(float newTarget)
+        {
+            if (newTarget == target)
+                return;
+
+            target = newTarget;
+
+            if (rampLength <= 0)
+            {
+                jump(newTarget);
+                return;
+            }
+
+            remaining = rampLength;
+            step = (target - current) / static_cast<float>(rampLength);
+        }
+
+        void jump(float value)
+        {
+            current = target = value;
+            remaining = 0;
+        }
+
+        float advance(int numSamples)
+        {
+            if (remaining <= numSamples)
+            {
+                current = target;
+                remaining = 0;
+            }
+            else
+            {
+                current += step * static_cast<float>(numSamples);
+                remaining -= numSamples;
+            }
+            return current;
+        }
+
+        bool isRamping() const { return remaining > 0; }
+        float getCurrent() const { return current; }
+        float getTarget() const { return target; }
+
+    private:
+        float current = 0.0f, target = 0.0f, step = 0.0f;
+        int remaining = 0, rampLength = 0;
+    };
+
+    class ControlRateSmoother
+    {
+    public:
+        static constexpr int subBlockSize = 32;
+
+        // Bypass crossfades the wet level alone, over its own shorter time
+        void prepare(double sampleRate, double rampSeconds = 0.05, double bypassFadeSeconds = 0.01)
+        {
+            cache.prepare(sampleRate);
+            const int rampLength = static_cast<int>(std::lround(sampleRate * rampSeconds));
+            freq.setRampLength(rampLength);
+            weight.setRampLength(rampLength);
+            strength.setRampLength(rampLength);
+            enabled.setRampLength(static_cast<int>(std::lround(sampleRate * bypassFadeSeconds)));
+        }
+
+        // Snaps to the given values without a glide, e.g. after prepareToPlay
+        void reset(float newFreq, float newWeight, float newStrength, bool bypassed = false)
+        {
+            freq.jump(newFreq);
+            weight.jump(newWeight);
+            strength.jump(newStrength);
+            enabled.jump(bypassed ? 0.0f : 1.0f);
+            current = cache.update(newFreq, newWeight, newStrength);
+        }
+
+        // Takes over another smoother's current values and targets, e.g. one
+        // running at a different rate; glides still under way restart from
+        // where the other one had got to
+        void follow(const ControlRateSmoother& other)
+        {
+            freq.jump(other.freq.getCurrent());
+            weight.jump(other.weight.getCurrent());
+            strength.jump(other.strength.getCurrent());
+            enabled.jump(other.enabled.getCurrent());
+            current = cache.update(freq.getCurrent(), weight.getCurrent(), strength.getCurrent());
+            setTargets(other.freq.getTarget(), other.weight.getTarget(), other.strength.getTarget(),
+                other.enabled.getTarget() < 0.5f);
+        }
+
+        void setTargets(float newFreq, float newWeight, float newStrength, bool bypassed = false)
+        {
+            freq.setTarget(newFreq);
+            weight.setTarget(newWeight);
+            strength.setTarget(newStrength);
+            enabled.setTarget(bypassed ? 0.0f : 1.0f);
+        }
+
+        bool isSmoothing() const
+        {
+            return freq.isRamping() || weight.isRamping() || strength.isRamping() || enabled.isRamping();
+        }
+
+        // Bypassed or at Weight 0 with every fade finished: the output is the dry input
+        bool isFullyDry() const { return !isSmoothing() && wetLevel() == 0.0f; }
+
+        // Moves the glides on by numSamples without producing any ramps, for
+        // blocks where the cascade is not run at all
+        void skip(int numSamples)
+        {
+            if (!isSmoothing())
+                return;
+
+            const float f = freq.advance(numSamples);
+            const float w = weight.advance(numSamples);
+            const float s = strength.advance(numSamples);
+            enabled.advance(numSamples);
+            current = cache.calculate(f, w, s);
+        }
+
+        // Calls segment(startSample, numSamples, ControlRamp) for consecutive
+        // runs covering the block: one run when static, sub-blocks otherwise.
+        template<typename SegmentCallback>
+        void process(int numSamples, SegmentCallback&& segment)
+        {
+            if (!isSmoothing())
+            {
+                current = cache.update(freq.getCurrent(), weight.getCurrent(), strength.getCurrent());
+                segment(0, numSamples, ControlRamp::constant(current, wetLevel()));
+                return;
+            }
+
+            for (int start = 0; start < numSamples; start += subBlockSize)
+            {
+                const int length = std::min(subBlockSize, numSamples - start);
+                const float wetFrom = wetLevel();
+                const float f = freq.advance(length);
+                const float w = weight.advance(length);
+                const float s = strength.advance(length);
+                enabled.advance(length);
+
+                // The coefficients follow Weight itself; only the mix fades with bypass
+                const auto target = cache.calculate(f, w, s);
+                segment(start, length, ControlRamp{ current, target, wetFrom, wetLevel() });
+                current = target;
+            }
+        }
+
+    private:
+        float wetLevel() const { return weight.getCurrent() * enabled.getCurrent(); }
+
+        CoefficientCache cache;
+        LinearRamp freq, weight, strength, enabled;
+        Coefficients current;
+    };
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Compact binary plugin state. Every stored parameter keeps its plain
+// (denormalised) value as a 32-bit float at a fixed offset, so reading and
+// writing are a few dozen byte copies on the stack instead of building and
+// parsing an XML document. All fields are little-endian:
+//
+//   0   'W' 'A' 'S' 'T'
+//   4   uint16 version
+//   6   uint16 count of stored values
+//   8   int32  current program
+//   12  float  values[count], in the order of parameterIds
+//   ..  uint32 FNV-1a checksum of every byte before it
+//
+// New parameters are appended to parameterIds, which leaves the version
+// alone: a reader takes the values it knows and ignores the rest, and the
+// values an older blob lacks keep their defaults. The version only changes if
+// the meaning of a stored field does, and readers reject versions newer than
+// their own. JUCE-free, so tools can inspect saved states too.
+namespace WeightAlphaState
+{
+    inline constexpr const char* parameterIds[] = {
+        "freq", "weight", "strength", "bypass", "freqRange", "dither",
+        "poles", "engine", "precision", "oversampling", "oversamplingMode", "governor"
+    };
+
+    inline constexpr int numValues = static_cast<int>(sizeof(parameterIds) / sizeof(parameterIds[0]));
+    inline constexpr uint16_t version = 1;
+    inline constexpr size_t headerSize = 12;
+
+    inline constexpr size_t sizeFor(int count) { return headerSize + 4 * static_cast<size_t>(count) + 4; }
+
+    // Bytes write() needs for this build's parameters
+    inline constexpr size_t maxSize = sizeFor(numValues);
+
+    struct State
+    {
+        int32_t program = 0;
+        float values[numValues] = {};
+        int numStored = numValues; // values a read found; later ones were not in the blob
+    };
+
+    namespace detail
+    {
+        inline void put16(uint8_t* p, uint16_t v) { p[0] = static_cast<uint8_t>(v); p[1] = static_cast<uint8_t>(v >> 8); }
+        inline uint16_t get16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+
+        inline void put32(uint8_t* p, uint32_t v)
+        {
+            for (int i = 0; i < 4; ++i)
+                p[i] = static_cast<uint8_t>(v >> (8 * i));
+        }
+
+        inline uint32_t get32(const uint8_t* p)
+        {
+            return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8
+                 | static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+        }
+
+        inline uint32_t checksum(const uint8_t* p, size_t size)
+        {
+            uint32_t h = 2166136261u;
+            for (size_t i = 0; i < size; ++i)
+                h = (h ^ p[i]) * 16777619u;
+            return h;
+        }
+
+        inline constexpr uint8_t magic[4] = { 'W', 'A', 'S', 'T' };
+    }
+
+    // True when data starts like a binary state, valid or not; anything else
+    // is left to the legacy XML reader
+    inline bool isBinary(const void* data, size_t size)
+    {
+        return data != nullptr && size >= sizeof(detail::magic) && std::memcmp(data, detail::magic, sizeof(detail::magic)) == 0;
+    }
+
+    // Writes state into out and returns the bytes used, or 0 if capacity is
+    // below maxSize
+    inline size_t write(const State& state, uint8_t* out, size_t capacity)
+    {
+        if (capacity < maxSize)
+            return 0;
+
+        std::memcpy(out, detail::magic, sizeof(detail::magic));
+        detail::put16(out + 4, version);
+        detail::put16(out + 6, static_cast<uint16_t>(numValues));
+        detail::put32(out + 8, static_cast<uint32_t>(state.program));
+
+        for (int i = 0; i < numValues; ++i)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &state.values[i], sizeof bits);
+            detail::put32(out + headerSize + 4 * static_cast<size_t>(i), bits);
+        }
+
+        const size_t body = maxSize - 4;
+        detail::put32(out + body, detail::checksum(out, body));
+        return maxSize;
+    }
+
+    // Fills state from a blob any build wrote, with more or fewer values than
+    // this one knows. False, leaving state untouched, for anything truncated,
+    // corrupted or of a newer version.
+    inline bool read(const void* data, size_t size, State& state)
+    {
+        if (!isBinary(data, size) || size < headerSize)
+            return false;
+
+        const auto* in = static_cast<const uint8_t*>(data);
+        const int count = detail::get16(in + 6);
+        const size_t body = sizeFor(count) - 4;
+
+        if (detail::get16(in + 4) > version || size < sizeFor(count) || detail::get32(in + body) != detail::checksum(in, body))
+            return false;
+
+        state.program = static_cast<int32_t>(detail::get32(in + 8));
+        state.numStored = count < numValues ? count : numValues;
+
+        for (int i = 0; i < state.numStored; ++i)
+        {
+            const uint32_t bits = detail::get32(in + headerSize + 4 * static_cast<size_t>(i));
+            std::memcpy(&state.values[i], &bits, sizeof bits);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,204 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include "WeightAlphaDSP.h"
+
+// Block state-space form of the cascade. With alpha/beta fixed, every stage is
+// a linear two-state recurrence, so the whole cascade is one linear system
+//     s[n+1] = A s[n] + B u[n],   y[n] = C s[n+1]
+// with up to 2 * maxStages states. Processing blockLength samples at once as
+//     y    = O s + T u          (O = C A^(k+1), T = lower-triangular C A^m B)
+//     s'   = A^K s + G u        (G = A^(K-1-j) B)
+// turns the serial dependency chain through every stage and sample into
+// independent multiply-adds, which keeps the FPU busy on long offline blocks.
+// The wet/dry mix is folded into O and T. Matrices are rebuilt only when the
+// coefficients, weight or stage count change.
+namespace WeightAlphaDSP
+{
+    class StateSpaceEngine
+    {
+    public:
+        static constexpr int blockLength = 16;
+        static constexpr int maxOrder = 2 * maxStages;
+
+        // Matrix rebuild costs roughly (2 * numStages + 1) * blockLength cascade
+        // steps; it is skipped when nothing changed
+        void setCoefficients(const Coefficients& c, float newWeight, int newNumStages)
+        {
+            newNumStages = std::clamp(newNumStages, 1, maxStages);
+
+            if (valid && c.alpha == coeffs.alpha && c.beta == coeffs.beta
+                && newWeight == weight && newNumStages == numStages)
+                return;
+
+            coeffs = c;
+            weight = newWeight;
+            numStages = newNumStages;
+            order = 2 * numStages;
+
+            WeightAlphaTrace::Scope trace("stateSpaceRebuild", "dsp", "stages", numStages);
+            rebuild();
+            valid = true;
+        }
+
+        // Same contract as processCascade with a constant ramp. The block
+        // maths is always double; S only sets how the state is stored.
+        template<typename S, typename T>
+        void process(CascadeState<S>& st, T* const* channels, int numChannels, int startSample, int numSamples,
+            int stride = 1) const
+        {
+            numChannels = std::min(numChannels, st.numChannels);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                alignas(32) double s[maxOrder];
+                st.readChannel(ch, numStages, s);
+                processChannel(s, channels[ch] + startSample * stride, numSamples, stride);
+                st.writeChannel(ch, numStages, s);
+            }
+        }
+
+        // One sample of the cascade on an unpacked state vector; returns the wet signal
+        double step(double* s, double u) const
+        {
+            double x = u;
+
+            for (int i = 0; i < numStages; ++i)
+            {
+                const double prev = s[2 * i], trend = s[2 * i + 1];
+                const double newTrend = coeffs.beta * (x - prev) + (0.999 - coeffs.beta) * trend;
+                x = coeffs.alpha * x + (0.999 - coeffs.alpha) * (prev + trend);
+                s[2 * i] = x;
+                s[2 * i + 1] = newTrend;
+            }
+
+            return x;
+        }
+
+        int getOrder() const { return order; }
+        int getNumStages() const { return numStages; }
+
+        // A^blockLength, column j at [j * maxOrder]; only the top-left
+        // getOrder() x getOrder() corner is meaningful
+        const double* getBlockTransition() const { return stateFromState[0].data(); }
+
+        // Processes one channel in place starting from the unpacked state s,
+        // leaving the end state in s. Sample n is data[n * stride].
+        template<typename T>
+        void processChannel(double* s, T* data, int numSamples, int stride = 1) const
+        {
+            const int numBlocks = numSamples / blockLength;
+
+            for (int b = 0; b < numBlocks; ++b, data += blockLength * stride)
+            {
+                alignas(32) double u[blockLength], y[blockLength] = {}, next[maxOrder] = {};
+
+                for (int k = 0; k < blockLength; ++k)
+                    u[k] = static_cast<double>(data[k * stride]);
+
+                for (int j = 0; j < order; ++j)
+                {
+                    axpy(y, outputFromState[j].data(), s[j], blockLength);
+                    axpy(next, stateFromState[j].data(), s[j], order);
+                }
+
+                for (int j = 0; j < blockLength; ++j)
+                {
+                    axpy(y + j, outputFromInput[j].data() + j, u[j], blockLength - j);
+                    axpy(next, stateFromInput[j].data(), u[j], order);
+                }
+
+                for (int k = 0; k < blockLength; ++k)
+                    data[k * stride] = static_cast<T>(y[k]);
+
+                std::copy(next, next + order, s);
+            }
+
+            for (int n = numBlocks * blockLength; n < numSamples; ++n, data += stride)
+            {
+                const double dry = static_cast<double>(*data);
+                *data = static_cast<T>(step(s, dry) * weight + dry * (1.0f - weight));
+            }
+        }
+
+        // Like processChannel but only advances s, leaving the audio untouched
+        template<typename T>
+        void advanceState(double* s, const T* data, int numSamples) const
+        {
+            const int numBlocks = numSamples / blockLength;
+
+            for (int b = 0; b < numBlocks; ++b, data += blockLength)
+            {
+                alignas(32) double next[maxOrder] = {};
+
+                for (int j = 0; j < order; ++j)
+                    axpy(next, stateFromState[j].data(), s[j], order);
+
+                for (int j = 0; j < blockLength; ++j)
+                    axpy(next, stateFromInput[j].data(), static_cast<double>(data[j]), order);
+
+                std::copy(next, next + order, s);
+            }
+
+            for (int n = numBlocks * blockLength; n < numSamples; ++n, ++data)
+                step(s, static_cast<double>(*data));
+        }
+
+    private:
+        static void axpy(double* y, const double* x, double a, int n)
+        {
+            for (int i = 0; i < n; ++i)
+                y[i] += a * x[i];
+        }
+
+        void rebuild()
+        {
+            // Zero-input response from each unit state: column j of A^K, and
+            // the wet output after each of the K steps for row k of O
+            for (int j = 0; j < order; ++j)
+            {
+                alignas(32) double v[maxOrder] = {};
+                v[j] = 1.0;
+
+                for (int k = 0; k < blockLength; ++k)
+                    outputFromState[j][k] = weight * step(v, 0.0);
+
+                std::copy(v, v + order, stateFromState[j].begin());
+            }
+
+            // Impulse response h[m] = C A^m B, and A^m B for the input-to-state map
+            alignas(32) double v[maxOrder] = {};
+            double h[blockLength];
+            h[0] = step(v, 1.0);
+            std::copy(v, v + order, stateFromInput[blockLength - 1].begin());
+
+            for (int m = 1; m < blockLength; ++m)
+            {
+                h[m] = step(v, 0.0);
+                std::copy(v, v + order, stateFromInput[blockLength - 1 - m].begin());
+            }
+
+            // Column j of T holds the response to u[j]: T[k][j] = h[k - j], plus dry on the diagonal
+            for (int j = 0; j < blockLength; ++j)
+            {
+                auto& column = outputFromInput[j];
+                column.fill(0.0);
+
+                for (int k = j; k < blockLength; ++k)
+                    column[k] = weight * h[k - j];
+
+                column[j] += 1.0f - weight;
+            }
+        }
+
+        Coefficients coeffs;
+        float weight = 1.0f;
+        int numStages = defaultStages, order = 2 * defaultStages;
+        bool valid = false;
+
+        std::array<std::array<double, blockLength>, maxOrder> outputFromState{};   // O, by column
+        std::array<std::array<double, blockLength>, blockLength> outputFromInput{}; // T, by column
+        std::array<std::array<double, maxOrder>, maxOrder> stateFromState{};       // A^K, by column
+        std::array<std::array<double, maxOrder>, blockLength> stateFromInput{};    // G, by column
+    };
+}
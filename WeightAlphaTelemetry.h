@@ -0,0 +1,433 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+ #endif
+ #include <windows.h>
+ #include <sddl.h>
+ #if defined(_MSC_VER)
+  #pragma comment(lib, "advapi32.lib")
+ #endif
+#else
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <signal.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+// Per-user telemetry: every instance claims a slot in one named shared memory
+// segment and publishes its live cost and settings there after each block, so
+// a reader (Tools/WeightAlphaTelemetry.cpp) can list every instance the user
+// is running. The segment is private to its user (mode 0600 and the uid in
+// its name, or the user's SID on Windows), since anyone who can resize it can
+// make every publisher fault. The segment is mapped and the slot claimed when
+// an instance is created; publishing is a seqlock write of plain atomics into
+// the mapped page, with no system calls and no locks. Deliberately free of
+// JUCE so the reader builds without it.
+namespace WeightAlphaTelemetry
+{
+    constexpr uint32_t magic = 0x57414c54; // "WALT"
+    constexpr uint32_t version = 1;
+    constexpr int numSlots = 1024;
+
+    // The calling user's segment name, written into name
+    inline void segmentName(char (&name)[128])
+    {
+#if defined(_WIN32)
+        // Local\ objects are per session and by default only open to their
+        // creator; the SID keeps apart users sharing a session (runas, services)
+        char sid[96] = "unknown";
+        HANDLE token = nullptr;
+        if (OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token))
+        {
+            alignas(TOKEN_USER) unsigned char user[sizeof(TOKEN_USER) + SECURITY_MAX_SID_SIZE];
+            DWORD size = 0;
+            LPSTR text = nullptr;
+            if (GetTokenInformation(token, TokenUser, user, sizeof(user), &size)
+                && ConvertSidToStringSidA(reinterpret_cast<TOKEN_USER*>(user)->User.Sid, &text))
+            {
+                std::snprintf(sid, sizeof(sid), "%s", text);
+                LocalFree(text);
+            }
+            CloseHandle(token);
+        }
+        std::snprintf(name, sizeof(name), "Local\\WeightAlphaTelemetry1-%s", sid);
+#else
+        std::snprintf(name, sizeof(name), "/weightalpha-telemetry-1-%u", static_cast<unsigned>(geteuid()));
+#endif
+    }
+
+    // Fixed-width fields only, so processes built by different compilers
+    // agree on the layout; floats travel as their bits
+    struct alignas(64) Slot
+    {
+        std::atomic<uint32_t> owner;      // process id, 0 while free
+        std::atomic<uint32_t> sequence;   // odd while a block is being published
+        std::atomic<uint64_t> instanceId; // tells a reused slot from its previous owner
+        std::atomic<uint64_t> updatedNs;  // steady clock of the last publish
+        std::atomic<uint64_t> blocks;
+        std::atomic<uint64_t> xruns;      // blocks that took longer than they last
+        std::atomic<uint64_t> busyNs;     // processing time, summed
+        std::atomic<uint64_t> audioNs;    // audio time processed, summed
+        std::atomic<uint64_t> lastBlockNs;
+        std::atomic<uint32_t> sampleRate;
+        std::atomic<uint32_t> blockSize;
+        std::atomic<uint32_t> numChannels;
+        std::atomic<uint32_t> freqHz;     // float bits
+        std::atomic<uint32_t> weight;     // float bits
+        std::atomic<uint32_t> strength;   // float bits
+        std::atomic<uint32_t> poles;
+        std::atomic<uint32_t> oversampling;
+        std::atomic<uint32_t> precision;
+        std::atomic<uint32_t> qualityTier;
+        std::atomic<uint32_t> flags;      // flagBypass | flagStateSpace
+    };
+
+    constexpr uint32_t flagBypass = 1;
+    constexpr uint32_t flagStateSpace = 2;
+
+    struct Header
+    {
+        std::atomic<uint32_t> magic;
+        std::atomic<uint32_t> version;
+        std::atomic<uint32_t> numSlots;
+        std::atomic<uint32_t> slotSize;
+    };
+
+    struct alignas(64) Segment
+    {
+        Header header;
+        Slot slots[numSlots];
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+        "shared-memory fields must be lock-free atomics");
+
+    // One block's worth of figures, as handed to Publisher::publish
+    struct BlockReport
+    {
+        uint64_t processingNs = 0;
+        double sampleRate = 0.0;
+        int blockSize = 0;
+        int numChannels = 0;
+        bool realtime = true;
+        float freqHz = 0.0f, weight = 0.0f, strength = 0.0f;
+        int poles = 0, oversampling = 1, precision = 0, qualityTier = 0;
+        bool bypass = false, stateSpace = false;
+    };
+
+    // A consistent copy of one slot, for readers
+    struct SlotSnapshot
+    {
+        uint32_t owner = 0;
+        uint64_t instanceId = 0, updatedNs = 0, blocks = 0, xruns = 0, busyNs = 0, audioNs = 0, lastBlockNs = 0;
+        uint32_t sampleRate = 0, blockSize = 0, numChannels = 0;
+        float freqHz = 0.0f, weight = 0.0f, strength = 0.0f;
+        uint32_t poles = 0, oversampling = 0, precision = 0, qualityTier = 0, flags = 0;
+    };
+
+    namespace detail
+    {
+        inline uint32_t floatBits(float x)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &x, sizeof bits);
+            return bits;
+        }
+
+        inline float bitsFloat(uint32_t bits)
+        {
+            float x;
+            std::memcpy(&x, &bits, sizeof x);
+            return x;
+        }
+
+        inline uint64_t nowNs()
+        {
+            const auto t = std::chrono::steady_clock::now().time_since_epoch();
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count());
+        }
+
+        inline uint32_t currentProcessId()
+        {
+#if defined(_WIN32)
+            return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+            return static_cast<uint32_t>(getpid());
+#endif
+        }
+
+        inline bool processAlive(uint32_t pid)
+        {
+#if defined(_WIN32)
+            HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+            if (process == nullptr)
+                return false;
+            DWORD code = 0;
+            const bool alive = GetExitCodeProcess(process, &code) && code == STILL_ACTIVE;
+            CloseHandle(process);
+            return alive;
+#else
+            return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+#endif
+        }
+
+        // Maps the segment, creating it if asked; nullptr on failure
+        class Mapping
+        {
+        public:
+            ~Mapping() { close(); }
+
+            Segment* open(bool create)
+            {
+                close();
+                char name[128];
+                segmentName(name);
+#if defined(_WIN32)
+                handle = create ? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                      static_cast<DWORD>(sizeof(Segment)), name)
+                                : OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+                if (handle == nullptr)
+                    return nullptr;
+
+                segment = static_cast<Segment*>(MapViewOfFile(handle, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, sizeof(Segment)));
+#else
+                const int fd = create ? shm_open(name, O_RDWR | O_CREAT, 0600) : shm_open(name, O_RDONLY, 0);
+                if (fd < 0)
+                    return nullptr;
+
+                // Only a segment this user owns and nobody else can open, of
+                // exactly the expected size (or new and empty), is mapped
+                struct stat info {};
+                const bool trusted = fstat(fd, &info) == 0 && info.st_uid == geteuid() && (info.st_mode & 077) == 0;
+                const bool sized = trusted
+                    && (static_cast<size_t>(info.st_size) == sizeof(Segment)
+                        || (create && info.st_size == 0 && ftruncate(fd, sizeof(Segment)) == 0));
+                void* p = sized ? mmap(nullptr, sizeof(Segment), create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0)
+                                : MAP_FAILED;
+                ::close(fd);
+                segment = p != MAP_FAILED ? static_cast<Segment*>(p) : nullptr;
+#endif
+                return segment;
+            }
+
+            void close()
+            {
+#if defined(_WIN32)
+                if (segment != nullptr)
+                    UnmapViewOfFile(segment);
+                if (handle != nullptr)
+                    CloseHandle(handle);
+                handle = nullptr;
+#else
+                if (segment != nullptr)
+                    munmap(segment, sizeof(Segment));
+#endif
+                segment = nullptr;
+            }
+
+        private:
+            Segment* segment = nullptr;
+#if defined(_WIN32)
+            HANDLE handle = nullptr;
+#endif
+        };
+    }
+
+    // The writing side, one per processor instance
+    class Publisher
+    {
+    public:
+        ~Publisher() { close(); }
+
+        // Maps the segment and claims a free slot, or one whose process has
+        // died. System calls; never from the audio thread. False if the
+        // segment is unavailable or full, in which case publish() does nothing.
+        bool open()
+        {
+            close();
+            segment = mapping.open(true);
+            if (segment == nullptr)
+                return false;
+
+            auto& header = segment->header;
+            uint32_t expected = 0;
+            if (header.magic.load(std::memory_order_acquire) == 0)
+            {
+                header.version.store(version, std::memory_order_relaxed);
+                header.numSlots.store(numSlots, std::memory_order_relaxed);
+                header.slotSize.store(sizeof(Slot), std::memory_order_relaxed);
+                header.magic.compare_exchange_strong(expected, magic, std::memory_order_release);
+            }
+
+            if (header.magic.load(std::memory_order_acquire) != magic || header.version.load(std::memory_order_relaxed) != version)
+            {
+                close();
+                return false;
+            }
+
+            const uint32_t pid = detail::currentProcessId();
+
+            for (auto& candidate : segment->slots)
+            {
+                uint32_t owner = candidate.owner.load(std::memory_order_acquire);
+                if ((owner == 0 || !detail::processAlive(owner))
+                    && candidate.owner.compare_exchange_strong(owner, pid, std::memory_order_acq_rel))
+                {
+                    slot = &candidate;
+                    break;
+                }
+            }
+
+            if (slot == nullptr)
+            {
+                close();
+                return false;
+            }
+
+            // Odd while the fields are cleared, then even; readers skip it until the first block
+            const uint32_t s = slot->sequence.load(std::memory_order_relaxed);
+            slot->sequence.store(s | 1u, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot->instanceId.store(detail::nowNs() ^ (static_cast<uint64_t>(pid) << 32) ^ reinterpret_cast<uintptr_t>(this),
+                std::memory_order_relaxed);
+            for (auto* field : { &slot->updatedNs, &slot->blocks, &slot->xruns, &slot->busyNs, &slot->audioNs, &slot->lastBlockNs })
+                field->store(0, std::memory_order_relaxed);
+            slot->sequence.store((s | 1u) + 1, std::memory_order_release);
+
+            blocks = xruns = busyNs = audioNs = 0;
+            return true;
+        }
+
+        void close()
+        {
+            if (slot != nullptr)
+                slot->owner.store(0, std::memory_order_release);
+
+            slot = nullptr;
+            segment = nullptr;
+            mapping.close();
+        }
+
+        bool isOpen() const { return slot != nullptr; }
+
+        // Audio thread: stores into the mapped slot, nothing else
+        void publish(const BlockReport& r)
+        {
+            if (slot == nullptr || r.blockSize <= 0 || !(r.sampleRate > 0.0))
+                return;
+
+            const auto blockNs = static_cast<uint64_t>(r.blockSize * 1.0e9 / r.sampleRate);
+            ++blocks;
+            busyNs += r.processingNs;
+            audioNs += blockNs;
+            if (r.realtime && r.processingNs > blockNs)
+                ++xruns;
+
+            const uint32_t s = slot->sequence.load(std::memory_order_relaxed);
+            slot->sequence.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            slot->updatedNs.store(detail::nowNs(), std::memory_order_relaxed);
+            slot->blocks.store(blocks, std::memory_order_relaxed);
+            slot->xruns.store(xruns, std::memory_order_relaxed);
+            slot->busyNs.store(busyNs, std::memory_order_relaxed);
+            slot->audioNs.store(audioNs, std::memory_order_relaxed);
+            slot->lastBlockNs.store(r.processingNs, std::memory_order_relaxed);
+            slot->sampleRate.store(static_cast<uint32_t>(r.sampleRate + 0.5), std::memory_order_relaxed);
+            slot->blockSize.store(static_cast<uint32_t>(r.blockSize), std::memory_order_relaxed);
+            slot->numChannels.store(static_cast<uint32_t>(r.numChannels), std::memory_order_relaxed);
+            slot->freqHz.store(detail::floatBits(r.freqHz), std::memory_order_relaxed);
+            slot->weight.store(detail::floatBits(r.weight), std::memory_order_relaxed);
+            slot->strength.store(detail::floatBits(r.strength), std::memory_order_relaxed);
+            slot->poles.store(static_cast<uint32_t>(r.poles), std::memory_order_relaxed);
+            slot->oversampling.store(static_cast<uint32_t>(r.oversampling), std::memory_order_relaxed);
+            slot->precision.store(static_cast<uint32_t>(r.precision), std::memory_order_relaxed);
+            slot->qualityTier.store(static_cast<uint32_t>(r.qualityTier), std::memory_order_relaxed);
+            slot->flags.store((r.bypass ? flagBypass : 0u) | (r.stateSpace ? flagStateSpace : 0u), std::memory_order_relaxed);
+
+            slot->sequence.store(s + 2, std::memory_order_release);
+        }
+
+    private:
+        detail::Mapping mapping;
+        Segment* segment = nullptr;
+        Slot* slot = nullptr;
+        uint64_t blocks = 0, xruns = 0, busyNs = 0, audioNs = 0;
+    };
+
+    // The reading side: maps the segment read-only
+    class Reader
+    {
+    public:
+        bool open()
+        {
+            segment = mapping.open(false);
+            if (segment != nullptr && (segment->header.magic.load(std::memory_order_acquire) != magic
+                                          || segment->header.version.load(std::memory_order_relaxed) != version))
+            {
+                mapping.close();
+                segment = nullptr;
+            }
+            return segment != nullptr;
+        }
+
+        // False for a free slot, or one that kept changing while being read
+        bool read(int index, SlotSnapshot& out) const
+        {
+            const Slot& slot = segment->slots[index];
+
+            for (int attempt = 0; attempt < 100; ++attempt)
+            {
+                const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+                if ((before & 1u) != 0)
+                    continue;
+
+                out.owner = slot.owner.load(std::memory_order_relaxed);
+                out.instanceId = slot.instanceId.load(std::memory_order_relaxed);
+                out.updatedNs = slot.updatedNs.load(std::memory_order_relaxed);
+                out.blocks = slot.blocks.load(std::memory_order_relaxed);
+                out.xruns = slot.xruns.load(std::memory_order_relaxed);
+                out.busyNs = slot.busyNs.load(std::memory_order_relaxed);
+                out.audioNs = slot.audioNs.load(std::memory_order_relaxed);
+                out.lastBlockNs = slot.lastBlockNs.load(std::memory_order_relaxed);
+                out.sampleRate = slot.sampleRate.load(std::memory_order_relaxed);
+                out.blockSize = slot.blockSize.load(std::memory_order_relaxed);
+                out.numChannels = slot.numChannels.load(std::memory_order_relaxed);
+                out.freqHz = detail::bitsFloat(slot.freqHz.load(std::memory_order_relaxed));
+                out.weight = detail::bitsFloat(slot.weight.load(std::memory_order_relaxed));
+                out.strength = detail::bitsFloat(slot.strength.load(std::memory_order_relaxed));
+                out.poles = slot.poles.load(std::memory_order_relaxed);
+                out.oversampling = slot.oversampling.load(std::memory_order_relaxed);
+                out.precision = slot.precision.load(std::memory_order_relaxed);
+                out.qualityTier = slot.qualityTier.load(std::memory_order_relaxed);
+                out.flags = slot.flags.load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == before)
+                    return out.owner != 0;
+            }
+
+            return false;
+        }
+
+        static bool isAlive(const SlotSnapshot& s) { return s.owner != 0 && detail::processAlive(s.owner); }
+
+    private:
+        detail::Mapping mapping;
+        Segment* segment = nullptr;
+    };
+}
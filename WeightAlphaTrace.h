@@ -0,0 +1,342 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(_WIN32)
+ #include <process.h>
+#else
+ #include <unistd.h>
+#endif
+
+// Opt-in trace recorder. Instrumented code records timed scopes into a
+// preallocated lock-free ring; a background thread drains it into a Chrome
+// trace-event JSON file, which chrome://tracing and the Perfetto UI open
+// directly. Timestamps are the steady clock (CLOCK_MONOTONIC on Linux), the
+// clock most host and system traces use, so the files line up with them.
+// While no trace runs, a scope costs one relaxed atomic load. Nothing on the
+// recording side locks or allocates. Deliberately free of JUCE so the DSP
+// core can be instrumented too.
+namespace WeightAlphaTrace
+{
+    struct Event
+    {
+        const char* name = nullptr;     // string literals only: the writer reads them later
+        const char* category = nullptr;
+        const char* argName = nullptr;  // optional single integer argument
+        int64_t arg = 0;
+        uint64_t startNs = 0, durationNs = 0;
+        uint32_t threadId = 0;
+        char phase = 'X';               // 'X' complete event, 'M' thread name
+    };
+
+    namespace detail
+    {
+        inline uint64_t nowNs()
+        {
+            const auto t = std::chrono::steady_clock::now().time_since_epoch();
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count());
+        }
+
+        // Small ids instead of the platform's thread handles; constant-initialised,
+        // so the first use on a thread does not allocate
+        inline uint32_t currentThreadId()
+        {
+            static std::atomic<uint32_t> next{ 1 };
+            thread_local uint32_t id = 0;
+            if (id == 0)
+                id = next.fetch_add(1, std::memory_order_relaxed);
+            return id;
+        }
+
+        // Bounded multi-producer queue with one consumer: every slot carries a
+        // sequence number saying whose turn it is, so producers claim slots
+        // with a compare-exchange and never wait for each other
+        class Ring
+        {
+        public:
+            void allocate(size_t minimumCapacity)
+            {
+                size_t capacity = 1;
+                while (capacity < minimumCapacity)
+                    capacity *= 2;
+
+                slots.reset(new Slot[capacity]);
+                mask = capacity - 1;
+                for (size_t i = 0; i < capacity; ++i)
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+
+                writeIndex.store(0, std::memory_order_relaxed);
+                readIndex = 0;
+            }
+
+            size_t capacity() const { return slots != nullptr ? mask + 1 : 0; }
+
+            // False when the ring is full; the event is dropped
+            bool push(const Event& e)
+            {
+                uint64_t pos = writeIndex.load(std::memory_order_relaxed);
+
+                for (;;)
+                {
+                    Slot& slot = slots[pos & mask];
+                    const uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<int64_t>(seq - pos);
+
+                    if (diff == 0)
+                    {
+                        if (writeIndex.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            slot.event = e;
+                            slot.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = writeIndex.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // Consumer only
+            bool pop(Event& e)
+            {
+                Slot& slot = slots[readIndex & mask];
+                if (slot.sequence.load(std::memory_order_acquire) != readIndex + 1)
+                    return false;
+
+                e = slot.event;
+                slot.sequence.store(readIndex + mask + 1, std::memory_order_release);
+                ++readIndex;
+                return true;
+            }
+
+        private:
+            struct Slot
+            {
+                std::atomic<uint64_t> sequence{ 0 };
+                Event event;
+            };
+
+            std::unique_ptr<Slot[]> slots;
+            uint64_t mask = 0;
+            std::atomic<uint64_t> writeIndex{ 0 };
+            uint64_t readIndex = 0;
+        };
+
+        class Recorder
+        {
+        public:
+            ~Recorder()
+            {
+                if (users > 0)
+                {
+                    users = 1;
+                    stop();
+                }
+            }
+
+            // Reference-counted so every instance in a process can ask for the
+            // same trace; only the first call opens the file. Allocates.
+            bool start(const char* path, size_t capacity)
+            {
+                std::lock_guard<std::mutex> lock(startStop);
+
+                if (users > 0)
+                {
+                    ++users;
+                    return true;
+                }
+
+                file = std::fopen(path, "w");
+                if (file == nullptr)
+                    return false;
+
+                // Allocated once: a producer that saw the previous trace as
+                // active may still be writing into the ring
+                if (ring.capacity() == 0)
+                    ring.allocate(capacity);
+
+                // Leftovers from a previous trace belong to no file
+                Event stale;
+                while (ring.pop(stale)) {}
+
+                std::fputs("{\"traceEvents\":[\n", file);
+                firstEvent = true;
+                dropped.store(0, std::memory_order_relaxed);
+                session.fetch_add(1, std::memory_order_relaxed);
+                users = 1;
+                running = true;
+                active.store(true, std::memory_order_release);
+                writer = std::thread([this] { writerLoop(); });
+                return true;
+            }
+
+            void stop()
+            {
+                std::lock_guard<std::mutex> lock(startStop);
+
+                if (users == 0 || --users > 0)
+                    return;
+
+                active.store(false, std::memory_order_release);
+                running = false;
+                writer.join();
+                drain();
+
+                std::fprintf(file, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":\"%llu\"}}\n",
+                    static_cast<unsigned long long>(dropped.load(std::memory_order_relaxed)));
+                std::fclose(file);
+                file = nullptr;
+            }
+
+            void record(const Event& e)
+            {
+                if (!ring.push(e))
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            std::atomic<bool> active{ false };
+            std::atomic<uint32_t> session{ 0 };
+
+        private:
+            void writerLoop()
+            {
+                while (running)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    drain();
+                }
+            }
+
+            void drain()
+            {
+                Event e;
+                bool wrote = false;
+
+                while (ring.pop(e))
+                {
+                    write(e);
+                    wrote = true;
+                }
+
+                if (wrote)
+                    std::fflush(file);
+            }
+
+            void write(const Event& e)
+            {
+                std::fputs(firstEvent ? "" : ",\n", file);
+                firstEvent = false;
+
+                if (e.phase == 'M')
+                {
+                    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                        processId(), e.threadId, e.name);
+                    return;
+                }
+
+                std::fprintf(file, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u",
+                    e.name, e.category, static_cast<double>(e.startNs) * 1.0e-3, static_cast<double>(e.durationNs) * 1.0e-3,
+                    processId(), e.threadId);
+
+                if (e.argName != nullptr)
+                    std::fprintf(file, ",\"args\":{\"%s\":%lld}", e.argName, static_cast<long long>(e.arg));
+
+                std::fputs("}", file);
+            }
+
+            static int processId()
+            {
+#if defined(_WIN32)
+                return _getpid();
+#else
+                return static_cast<int>(getpid());
+#endif
+            }
+
+            Ring ring;
+            std::mutex startStop;
+            std::thread writer;
+            std::atomic<bool> running{ false };
+            std::atomic<uint64_t> dropped{ 0 };
+            std::FILE* file = nullptr;
+            bool firstEvent = true;
+            int users = 0;
+        };
+
+        inline Recorder recorder;
+    }
+
+    // Starts writing a trace to path, or joins the one already running. The
+    // ring holds capacity events (fixed by the first trace in the process)
+    // between the writer's 50 ms drains; more are dropped and counted in the
+    // file. Call from a non-real-time thread.
+    inline bool start(const char* path, size_t capacity = 1 << 16) { return detail::recorder.start(path, capacity); }
+
+    // Ends this caller's share of the trace; the last one closes the file
+    inline void stop() { detail::recorder.stop(); }
+
+    inline bool isActive() { return detail::recorder.active.load(std::memory_order_relaxed); }
+
+    // Labels the calling thread in the trace, once per trace
+    inline void nameThisThread(const char* name)
+    {
+        if (!isActive())
+            return;
+
+        thread_local uint32_t namedIn = 0;
+        const uint32_t session = detail::recorder.session.load(std::memory_order_relaxed);
+        if (namedIn == session)
+            return;
+
+        namedIn = session;
+        Event e;
+        e.name = name;
+        e.threadId = detail::currentThreadId();
+        e.phase = 'M';
+        detail::recorder.record(e);
+    }
+
+    // Records the lifetime of the enclosing block as one complete event
+    class Scope
+    {
+    public:
+        Scope(const char* eventName, const char* eventCategory, const char* argumentName = nullptr, int64_t argument = 0)
+        {
+            if (!isActive())
+                return;
+
+            event.name = eventName;
+            event.category = eventCategory;
+            event.argName = argumentName;
+            event.arg = argument;
+            event.startNs = detail::nowNs();
+        }
+
+        ~Scope()
+        {
+            if (event.startNs == 0 || !isActive())
+                return;
+
+            event.durationNs = detail::nowNs() - event.startNs;
+            event.threadId = detail::currentThreadId();
+            detail::recorder.record(event);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Event event;
+    };
+}